@@ -0,0 +1,524 @@
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <atomic>
+#include <iostream>
+#include <memory>
+#include <new>
+#include <stdexcept>
+#include <random>
+#include <string>
+#include <vector>
+#include <sys/resource.h>
+#include "maze.hpp"
+#include "node.hpp"
+#include "grid.hpp"
+#include "pathing.hpp"
+#include "batch.hpp"
+#include "map_io.hpp"
+
+using namespace pathfinder2;
+
+// global allocation tracking so every run can report the peak heap it needed. each block
+// carries its size in a header in front of the pointer handed out.
+
+namespace {
+    constexpr std::size_t alloc_header = alignof(std::max_align_t);
+
+    std::atomic<std::size_t> live_bytes{0};
+    std::atomic<std::size_t> peak_bytes{0};
+
+    void *tracked_alloc(std::size_t size) {
+        auto *block = static_cast<unsigned char *>(std::malloc(size + alloc_header));
+        if (block == nullptr)
+            throw std::bad_alloc{};
+        std::memcpy(block, &size, sizeof(size));
+
+        std::size_t now = live_bytes.fetch_add(size, std::memory_order_relaxed) + size;
+        std::size_t peak = peak_bytes.load(std::memory_order_relaxed);
+        while (now > peak && !peak_bytes.compare_exchange_weak(peak, now, std::memory_order_relaxed)) {}
+
+        return block + alloc_header;
+    }
+
+    void tracked_free(void *ptr) {
+        if (ptr == nullptr)
+            return;
+        auto *block = static_cast<unsigned char *>(ptr) - alloc_header;
+        std::size_t size;
+        std::memcpy(&size, block, sizeof(size));
+        live_bytes.fetch_sub(size, std::memory_order_relaxed);
+        std::free(block);
+    }
+}
+
+void *operator new(std::size_t size) { return tracked_alloc(size); }
+void *operator new[](std::size_t size) { return tracked_alloc(size); }
+void operator delete(void *ptr) noexcept { tracked_free(ptr); }
+void operator delete[](void *ptr) noexcept { tracked_free(ptr); }
+void operator delete(void *ptr, std::size_t) noexcept { tracked_free(ptr); }
+void operator delete[](void *ptr, std::size_t) noexcept { tracked_free(ptr); }
+
+namespace {
+    struct BenchResult {
+        std::string algorithm;
+        int size;
+        std::uint32_t seed;
+        double wall_ms;
+        std::size_t nodes_expanded;
+        std::size_t path_len;
+        std::size_t peak_bytes;
+        SearchStats stats;
+    };
+
+    struct Options {
+        std::vector<int> sizes{101, 301, 1001};
+        int seeds = 3;
+        MazeAlgorithm maze = MazeAlgorithm::Backtracker;
+        bool json = false;
+        // random queries per maze for the batch api, 0 benches the algorithms instead
+        int batch = 0;
+        unsigned threads = 0;
+        // MovingAI scenario to run instead of mazes, the map defaults to the one it names
+        // looked up next to the scenario file
+        std::string scen{};
+        std::string map{};
+        // keep the ALT landmark table in <map>.alt instead of building it on the first query
+        bool landmarks = false;
+        // write one maze of maze_width x maze_height as a .map file instead of benching
+        std::string write_maze{};
+        int maze_width = 0;
+        int maze_height = 0;
+        std::uint32_t seed = 0;
+        // turn a MovingAI .map into the binary format instead of benching
+        std::string convert_from{};
+        std::string convert_to{};
+    };
+
+    struct ScenBenchResult {
+        std::string algorithm;
+        std::size_t scenarios;
+        std::size_t found;
+        double wall_ms;
+        std::size_t nodes_expanded;
+        // our path costs over the published optimal lengths, both in cells
+        double length_ratio;
+    };
+
+    struct BatchBenchResult {
+        int size;
+        std::uint32_t seed;
+        std::size_t queries;
+        std::size_t found;
+        unsigned threads;
+        double seconds;
+        double qps;
+    };
+
+    void print_usage(const char *argv0) {
+        std::cerr << "usage: " << argv0 << " [--sizes N,N,...] [--seeds N] [--maze backtracker|eller] [--json]"
+            " [--batch N [--threads N]] [--scen FILE [--map FILE] [--landmarks]]\n"
+            "       " << argv0 << " --write-maze FILE --size WxH [--seed N] [--maze backtracker|eller]\n"
+            "       " << argv0 << " --convert-map MAP_FILE BINARY_FILE\n";
+    }
+
+    bool parse_options(int argc, char **argv, Options &opts) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--json") {
+                opts.json = true;
+            }
+            else if (arg == "--maze" && i + 1 < argc) {
+                std::string maze = argv[++i];
+                if (maze == "backtracker")
+                    opts.maze = MazeAlgorithm::Backtracker;
+                else if (maze == "eller")
+                    opts.maze = MazeAlgorithm::Eller;
+                else
+                    return false;
+            }
+            else if (arg == "--batch" && i + 1 < argc) {
+                opts.batch = std::atoi(argv[++i]);
+            }
+            else if (arg == "--scen" && i + 1 < argc) {
+                opts.scen = argv[++i];
+            }
+            else if (arg == "--landmarks") {
+                opts.landmarks = true;
+            }
+            else if (arg == "--map" && i + 1 < argc) {
+                opts.map = argv[++i];
+            }
+            else if (arg == "--threads" && i + 1 < argc) {
+                opts.threads = static_cast<unsigned>(std::atoi(argv[++i]));
+            }
+            else if (arg == "--write-maze" && i + 1 < argc) {
+                opts.write_maze = argv[++i];
+            }
+            else if (arg == "--convert-map" && i + 2 < argc) {
+                opts.convert_from = argv[++i];
+                opts.convert_to = argv[++i];
+            }
+            else if (arg == "--size" && i + 1 < argc) {
+                char *end = nullptr;
+                opts.maze_width = static_cast<int>(std::strtol(argv[++i], &end, 10));
+                if (*end != 'x')
+                    return false;
+                const char *height = end + 1;
+                opts.maze_height = static_cast<int>(std::strtol(height, &end, 10));
+                if (end == height || *end != '\0')
+                    return false;
+            }
+            else if (arg == "--seed" && i + 1 < argc) {
+                opts.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (arg == "--seeds" && i + 1 < argc) {
+                opts.seeds = std::atoi(argv[++i]);
+            }
+            else if (arg == "--sizes" && i + 1 < argc) {
+                opts.sizes.clear();
+                for (const char *cur = argv[++i];;) {
+                    char *end = nullptr;
+                    long size = std::strtol(cur, &end, 10);
+                    if (end == cur)
+                        return false;
+                    opts.sizes.push_back(static_cast<int>(size));
+                    if (*end == '\0')
+                        break;
+                    if (*end != ',')
+                        return false;
+                    cur = end + 1;
+                }
+            }
+            else {
+                return false;
+            }
+        }
+
+        if (!opts.write_maze.empty())
+            return opts.maze_width > 0 && opts.maze_height > 0;
+        if (!opts.convert_from.empty())
+            return true;
+
+        for (int size : opts.sizes) {
+            if (size < 3)
+                return false;
+        }
+        return opts.seeds > 0 && opts.batch >= 0 && !opts.sizes.empty();
+    }
+
+    // mazes only carve out even coordinates so the end goes on the last even cell
+    Grid make_maze(int size, std::uint32_t seed, MazeAlgorithm algorithm) {
+        Grid grid{size, size};
+        generate_maze(grid, MazeOptions{seed, algorithm});
+
+        int last = (size - 1) & ~1;
+        grid.set({0, 0}, Node::Start);
+        grid.set({last, last}, Node::End);
+        return grid;
+    }
+
+    BenchResult run_one(const PathingAlgorithmInfo &entry, const Grid &grid, int size, std::uint32_t seed) {
+        auto algo = entry.make();
+
+        peak_bytes.store(live_bytes.load());
+        std::size_t base_bytes = live_bytes.load();
+
+        auto start = std::chrono::steady_clock::now();
+        auto result = algo->find_path(grid);
+        auto stop = std::chrono::steady_clock::now();
+
+        return {
+            entry.name,
+            size,
+            seed,
+            std::chrono::duration<double, std::milli>(stop - start).count(),
+            result.visited_cells().size(),
+            result.path_length(),
+            peak_bytes.load() - base_bytes,
+            result.stats(),
+        };
+    }
+
+    // queries between random walkable cells of the maze, the same ones for the same seed
+    BatchBenchResult run_batch(const Grid &grid, int size, std::uint32_t seed, int query_cnt, unsigned threads) {
+        std::mt19937 rng{seed};
+        std::vector<Point> walkable{};
+        for (int y = 0; y < grid.height(); y++) {
+            for (int x = 0; x < grid.width(); x++) {
+                if (grid.walkable(grid.index({x, y})))
+                    walkable.push_back({x, y});
+            }
+        }
+
+        std::vector<PathQuery> queries{};
+        for (int i = 0; i < query_cnt; i++)
+            queries.push_back({walkable[rng() % walkable.size()], walkable[rng() % walkable.size()]});
+
+        auto result = find_paths(grid, queries, threads);
+        auto found = std::count_if(result.answers.begin(), result.answers.end(), [](const auto &a) { return a.found(); });
+
+        return {
+            size,
+            seed,
+            queries.size(),
+            static_cast<std::size_t>(found),
+            result.threads,
+            result.seconds,
+            result.queries_per_second(),
+        };
+    }
+
+    // every algorithm answers every scenario with one instance, like a game reusing its pathfinder
+    std::vector<ScenBenchResult> run_scen(const Options &opts) {
+        std::ifstream scen_file{opts.scen};
+        if (!scen_file)
+            throw std::runtime_error("failed opening scenario " + opts.scen);
+        auto scenarios = read_movingai_scen(scen_file);
+
+        std::string map_path = opts.map;
+        if (map_path.empty() && !scenarios.empty()) {
+            auto dir_end = opts.scen.find_last_of('/');
+            auto name_start = scenarios.front().map.find_last_of('/');
+            map_path = (dir_end == std::string::npos ? "" : opts.scen.substr(0, dir_end + 1)) +
+                scenarios.front().map.substr(name_start == std::string::npos ? 0 : name_start + 1);
+        }
+        Grid grid = load_map(map_path);
+
+        // a stale or missing table gets rebuilt and saved for the next run
+        LandmarkTable landmarks{};
+        if (opts.landmarks) {
+            std::string table_path = map_path + ".alt";
+            if (std::ifstream table_file{table_path, std::ios::binary}) {
+                try {
+                    landmarks = LandmarkTable::load(table_file);
+                }
+                catch (std::runtime_error &e) {
+                    std::cerr << table_path << ": " << e.what() << ", rebuilding\n";
+                }
+            }
+
+            if (landmarks.empty() || !landmarks.matches(grid)) {
+                landmarks = LandmarkTable{grid, AltAStar::default_landmark_cnt};
+                std::ofstream table_file{table_path, std::ios::binary};
+                landmarks.save(table_file);
+            }
+        }
+
+        std::vector<ScenBenchResult> results{};
+        for (const auto &entry : pathing_algorithms()) {
+            auto algo = entry.make();
+            if (opts.landmarks && std::string{entry.name} == "ALT")
+                algo = std::make_unique<AltAStar>(landmarks);
+            ScenBenchResult res{entry.name, 0, 0, 0, 0, 0};
+            double cost_sum = 0, optimal_sum = 0;
+
+            // reused across queries like the app does, so only the first one pays for the buffers
+            SearchResult result{};
+            for (const auto &scen : scenarios) {
+                if (!grid.in_bounds(scen.start) || !grid.in_bounds(scen.end) || scen.start == scen.end)
+                    continue;
+
+                grid.set(scen.start, Node::Start);
+                algo->cell_changed(grid, scen.start);
+                grid.set(scen.end, Node::End);
+                algo->cell_changed(grid, scen.end);
+
+                auto start = std::chrono::steady_clock::now();
+                algo->find_path(grid, result);
+                auto stop = std::chrono::steady_clock::now();
+
+                res.scenarios++;
+                res.wall_ms += std::chrono::duration<double, std::milli>(stop - start).count();
+                res.nodes_expanded += result.visited_cells().size();
+                if (result.found()) {
+                    res.found++;
+                    cost_sum += result.path_cost() / 10.0;
+                    optimal_sum += scen.optimal_length;
+                }
+
+                grid.set(scen.start, Node::Walkable);
+                algo->cell_changed(grid, scen.start);
+                grid.set(scen.end, Node::Walkable);
+                algo->cell_changed(grid, scen.end);
+            }
+
+            res.length_ratio = optimal_sum > 0 ? cost_sum / optimal_sum : 0;
+            results.push_back(res);
+        }
+        return results;
+    }
+
+    void print_scen_table(const std::vector<ScenBenchResult> &results) {
+        std::printf("%-18s %10s %10s %12s %14s %12s\n", "algorithm", "scenarios", "found", "wall_ms", "expanded", "len_ratio");
+        for (const auto &res : results) {
+            std::printf("%-18s %10zu %10zu %12.3f %14zu %12.4f\n",
+                    res.algorithm.c_str(), res.scenarios, res.found, res.wall_ms, res.nodes_expanded, res.length_ratio);
+        }
+    }
+
+    void print_scen_json(const std::vector<ScenBenchResult> &results) {
+        std::printf("[\n");
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const auto &res = results[i];
+            std::printf("  {\"algorithm\": \"%s\", \"scenarios\": %zu, \"found\": %zu, \"wall_ms\": %.3f, "
+                    "\"nodes_expanded\": %zu, \"length_ratio\": %.6f}%s\n",
+                    res.algorithm.c_str(), res.scenarios, res.found, res.wall_ms, res.nodes_expanded, res.length_ratio,
+                    i + 1 < results.size() ? "," : "");
+        }
+        std::printf("]\n");
+    }
+
+    void print_batch_table(const std::vector<BatchBenchResult> &results) {
+        std::printf("%8s %10s %10s %10s %8s %12s %12s\n", "size", "seed", "queries", "found", "threads", "seconds", "qps");
+        for (const auto &res : results) {
+            std::printf("%8d %10u %10zu %10zu %8u %12.3f %12.1f\n",
+                    res.size, res.seed, res.queries, res.found, res.threads, res.seconds, res.qps);
+        }
+    }
+
+    void print_batch_json(const std::vector<BatchBenchResult> &results) {
+        std::printf("[\n");
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const auto &res = results[i];
+            std::printf("  {\"size\": %d, \"seed\": %u, \"queries\": %zu, \"found\": %zu, \"threads\": %u, "
+                    "\"seconds\": %.6f, \"qps\": %.1f}%s\n",
+                    res.size, res.seed, res.queries, res.found, res.threads, res.seconds, res.qps,
+                    i + 1 < results.size() ? "," : "");
+        }
+        std::printf("]\n");
+    }
+
+    void print_table(const std::vector<BenchResult> &results) {
+        std::printf("%-18s %8s %10s %12s %12s %10s %12s\n",
+                "algorithm", "size", "seed", "wall_ms", "expanded", "path_len", "peak_kib");
+        for (const auto &res : results) {
+            std::printf("%-18s %8d %10u %12.3f %12zu %10zu %12.1f\n",
+                    res.algorithm.c_str(), res.size, res.seed, res.wall_ms,
+                    res.nodes_expanded, res.path_len, res.peak_bytes / 1024.0);
+        }
+    }
+
+    void print_json(const std::vector<BenchResult> &results) {
+        std::printf("[\n");
+        for (std::size_t i = 0; i < results.size(); i++) {
+            const auto &res = results[i];
+            // the probe counters are only there when the library was built with them
+            std::string stats = search_stats_enabled ? ", \"stats\": " + res.stats.to_json() : "";
+            std::printf("  {\"algorithm\": \"%s\", \"size\": %d, \"seed\": %u, \"wall_ms\": %.3f, "
+                    "\"nodes_expanded\": %zu, \"path_len\": %zu, \"peak_bytes\": %zu%s}%s\n",
+                    res.algorithm.c_str(), res.size, res.seed, res.wall_ms,
+                    res.nodes_expanded, res.path_len, res.peak_bytes, stats.c_str(),
+                    i + 1 < results.size() ? "," : "");
+        }
+        std::printf("]\n");
+    }
+}
+
+int main(int argc, char **argv) {
+    Options opts{};
+    if (!parse_options(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // eller mazes go to the file a row at a time, so they can be far bigger than memory
+    if (!opts.write_maze.empty()) {
+        std::ofstream out{opts.write_maze, std::ios::binary};
+        if (!out) {
+            std::cerr << "failed opening " << opts.write_maze << "\n";
+            return 1;
+        }
+
+        try {
+            write_maze(out, opts.maze_width, opts.maze_height, MazeOptions{opts.seed, opts.maze});
+        }
+        catch (std::runtime_error &e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    // the binary map gets memory mapped by --map and the app instead of parsed
+    if (!opts.convert_from.empty()) {
+        std::ifstream in{opts.convert_from};
+        std::ofstream out{opts.convert_to, std::ios::binary};
+        if (!in || !out) {
+            std::cerr << "failed opening " << (!in ? opts.convert_from : opts.convert_to) << "\n";
+            return 1;
+        }
+
+        try {
+            convert_movingai_map(in, out);
+        }
+        catch (std::runtime_error &e) {
+            std::cerr << opts.convert_from << ": " << e.what() << "\n";
+            return 1;
+        }
+        return 0;
+    }
+
+    if (!opts.scen.empty()) {
+        std::vector<ScenBenchResult> results{};
+        try {
+            results = run_scen(opts);
+        }
+        catch (std::runtime_error &e) {
+            std::cerr << e.what() << "\n";
+            return 1;
+        }
+
+        if (opts.json)
+            print_scen_json(results);
+        else
+            print_scen_table(results);
+        return 0;
+    }
+
+    if (opts.batch > 0) {
+        std::vector<BatchBenchResult> results{};
+        for (int size : opts.sizes) {
+            for (int seed_ind = 0; seed_ind < opts.seeds; seed_ind++) {
+                auto seed = static_cast<std::uint32_t>(seed_ind);
+                auto grid = make_maze(size, seed, opts.maze);
+                results.push_back(run_batch(grid, size, seed, opts.batch, opts.threads));
+            }
+        }
+
+        if (opts.json)
+            print_batch_json(results);
+        else
+            print_batch_table(results);
+        return 0;
+    }
+
+    std::vector<BenchResult> results{};
+
+    for (int size : opts.sizes) {
+        for (int seed_ind = 0; seed_ind < opts.seeds; seed_ind++) {
+            auto seed = static_cast<std::uint32_t>(seed_ind);
+            auto grid = make_maze(size, seed, opts.maze);
+
+            for (const auto &entry : pathing_algorithms())
+                results.push_back(run_one(entry, grid, size, seed));
+        }
+    }
+
+    if (opts.json) {
+        print_json(results);
+    }
+    else {
+        print_table(results);
+
+        rusage usage{};
+        getrusage(RUSAGE_SELF, &usage);
+        std::printf("\nprocess max rss: %ld kib\n", usage.ru_maxrss);
+    }
+
+    return 0;
+}
@@ -0,0 +1,195 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "maze.hpp"
+#include "node.hpp"
+#include "grid.hpp"
+#include "open_list.hpp"
+#include "search_kernel.hpp"
+
+using namespace pathfinder2;
+
+// records the open list operations of real A* searches and plays them back on every open list,
+// so the queues get compared on the pushes and pops a grid search actually does instead of
+// random keys.
+
+namespace {
+    using Key = std::pair<int, int>;
+
+    struct QueueOp {
+        std::uint32_t node;
+        Key key;
+        bool pop;
+    };
+
+    struct Trace {
+        std::string pattern;
+        int size;
+        std::uint32_t seed;
+        std::size_t capacity = 0;
+        std::vector<QueueOp> ops{};
+    };
+
+    // the trace a RecordingQueue appends to
+    Trace *recording = nullptr;
+    // where the popped nodes go so the playback can't be optimized out
+    volatile std::uint64_t pop_sink = 0;
+
+    // a binary heap that writes down everything done to it
+    template <typename K>
+    class RecordingQueue : public IndexedBinaryHeap<K> {
+    public:
+        void reset(std::size_t capacity) {
+            IndexedBinaryHeap<K>::reset(capacity);
+            recording->capacity = capacity;
+        }
+
+        void push_or_decrease(std::uint32_t node, K key) {
+            IndexedBinaryHeap<K>::push_or_decrease(node, key);
+            recording->ops.push_back({node, key, false});
+        }
+
+        std::pair<std::uint32_t, K> pop() {
+            auto popped = IndexedBinaryHeap<K>::pop();
+            recording->ops.push_back({popped.first, popped.second, true});
+            return popped;
+        }
+    };
+
+    struct Options {
+        std::vector<int> sizes{301, 1001};
+        int seeds = 3;
+        // best of this many replays per trace and queue
+        int reps = 5;
+    };
+
+    void print_usage(const char *argv0) {
+        std::cerr << "usage: " << argv0 << " [--sizes N,N,...] [--seeds N] [--reps N]\n";
+    }
+
+    bool parse_options(int argc, char **argv, Options &opts) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--seeds" && i + 1 < argc) {
+                opts.seeds = std::atoi(argv[++i]);
+            }
+            else if (arg == "--reps" && i + 1 < argc) {
+                opts.reps = std::atoi(argv[++i]);
+            }
+            else if (arg == "--sizes" && i + 1 < argc) {
+                opts.sizes.clear();
+                for (const char *cur = argv[++i];;) {
+                    char *end = nullptr;
+                    long size = std::strtol(cur, &end, 10);
+                    if (end == cur)
+                        return false;
+                    opts.sizes.push_back(static_cast<int>(size));
+                    if (*end == '\0')
+                        break;
+                    if (*end != ',')
+                        return false;
+                    cur = end + 1;
+                }
+            }
+            else {
+                return false;
+            }
+        }
+
+        for (int size : opts.sizes) {
+            if (size < 3)
+                return false;
+        }
+        return opts.seeds > 0 && opts.reps > 0 && !opts.sizes.empty();
+    }
+
+    // the three kinds of map the searches here run on: a maze with one long winding route, an
+    // empty map where A* walks almost straight to the end, and scattered obsticals in between
+    Grid make_grid(const std::string &pattern, int size, std::uint32_t seed) {
+        Grid grid{size, size};
+        if (pattern == "maze") {
+            generate_maze(grid, MazeOptions{seed, MazeAlgorithm::Backtracker});
+        }
+        else if (pattern == "scatter") {
+            std::mt19937 rng{seed};
+            std::bernoulli_distribution blocked{0.3};
+            for (int y = 0; y < size; y++) {
+                for (int x = 0; x < size; x++) {
+                    if (blocked(rng))
+                        grid.set({x, y}, Node::Obstical);
+                }
+            }
+        }
+
+        int last = (size - 1) & ~1;
+        grid.set({0, 0}, Node::Start);
+        grid.set({last, last}, Node::End);
+        return grid;
+    }
+
+    Trace record(const std::string &pattern, int size, std::uint32_t seed) {
+        Trace trace{pattern, size, seed};
+        Grid grid = make_grid(pattern, size, seed);
+
+        recording = &trace;
+        SearchKernel<EightConnected, OctileHeuristic, int, RecordingQueue> kernel{};
+        kernel.search(grid, grid.find(Node::Start), grid.find(Node::End));
+        recording = nullptr;
+        return trace;
+    }
+
+    // ns per operation, the best of opts.reps runs. among equal priorities the queues may pop
+    // different nodes than the recorded ones, the playback carries on with whatever they hold.
+    template <template <typename> class Queue>
+    double replay(const Trace &trace, const Options &opts) {
+        Queue<Key> queue{trace.capacity};
+        double best = 0;
+        std::uint64_t sink = 0;
+
+        for (int rep = 0; rep < opts.reps; rep++) {
+            queue.clear();
+            auto start = std::chrono::steady_clock::now();
+            for (const auto &op : trace.ops) {
+                if (!op.pop)
+                    queue.push_or_decrease(op.node, op.key);
+                else if (!queue.empty())
+                    sink += queue.pop().first;
+            }
+            auto stop = std::chrono::steady_clock::now();
+
+            double ns = std::chrono::duration<double, std::nano>(stop - start).count() / static_cast<double>(trace.ops.size());
+            best = rep == 0 ? ns : std::min(best, ns);
+        }
+
+        pop_sink = sink;
+        return best;
+    }
+}
+
+int main(int argc, char **argv) {
+    Options opts{};
+    if (!parse_options(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    std::printf("%-10s %8s %8s %12s %12s %12s %12s\n", "pattern", "size", "seed", "ops", "binary_ns", "radix_ns", "buckets_ns");
+    for (const char *pattern : {"maze", "scatter", "open"}) {
+        for (int size : opts.sizes) {
+            for (int seed_ind = 0; seed_ind < opts.seeds; seed_ind++) {
+                auto seed = static_cast<std::uint32_t>(seed_ind);
+                Trace trace = record(pattern, size, seed);
+
+                std::printf("%-10s %8d %8u %12zu %12.2f %12.2f %12.2f\n", pattern, size, seed, trace.ops.size(),
+                        replay<IndexedBinaryHeap>(trace, opts), replay<RadixHeap>(trace, opts), replay<BucketQueue>(trace, opts));
+            }
+        }
+    }
+    return 0;
+}
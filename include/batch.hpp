@@ -0,0 +1,35 @@
+#pragma once
+
+#include <span>
+#include <vector>
+#include "node.hpp"
+#include "grid.hpp"
+
+namespace pathfinder2 {
+    struct PathQuery {
+        Point start, end;
+    };
+
+    struct PathAnswer {
+        // -1 when there is no path
+        int cost = -1;
+        // the start, every cell the path turns at and the end
+        std::vector<Point> corners{};
+
+        bool found() const { return cost >= 0; }
+    };
+
+    struct BatchResult {
+        // answers[i] belongs to queries[i]
+        std::vector<PathAnswer> answers{};
+        unsigned threads = 0;
+        double seconds = 0;
+
+        double queries_per_second() const { return seconds > 0 ? answers.size() / seconds : 0; }
+    };
+
+    // solves every query with A* on a work stealing pool of thread_cnt workers, 0 uses every
+    // core. the grid is only read and Start/End cells in it are just walkable cells. queries
+    // with an end point outside of the grid or on an obstical have no path.
+    BatchResult find_paths(const Grid &grid, std::span<const PathQuery> queries, unsigned thread_cnt = 0);
+}
@@ -0,0 +1,55 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+#include "node.hpp"
+#include "grid.hpp"
+
+namespace pathfinder2 {
+    // labels every walkable cell with the 8 connected region it belongs to (corners can be cut
+    // like the algorithms do), so whether one cell can reach another is a single comparison.
+    // cell_changed() keeps the labels up to date: opening a cell merges the regions around it by
+    // relabeling all but the biggest one, blocking a cell only floods its region again when the
+    // cell might have been what held it together.
+    class ComponentIndex {
+    public:
+        static constexpr std::uint32_t none = 0;
+
+        ComponentIndex() = default;
+        explicit ComponentIndex(const Grid &grid);
+
+        // labels from scratch with a two pass union find labeler
+        void rebuild(const Grid &grid);
+
+        const GridShape &shape() const { return grid_shape; }
+
+        // label of the region p is in, none for obsticals and cells outside of the grid
+        std::uint32_t component(Point p) const {
+            return grid_shape.in_bounds(p) ? labels[grid_shape.index(p)] : none;
+        }
+
+        bool connected(Point a, Point b) const {
+            std::uint32_t label = component(a);
+            return label != none && label == component(b);
+        }
+
+        std::size_t component_count() const { return sizes.size() - 1 - free_labels.size(); }
+
+        // called after the cell at p was edited
+        void cell_changed(const Grid &grid, Point p);
+
+    private:
+        GridShape grid_shape{};
+        // padded like the grid, the border is none
+        std::vector<std::uint32_t> labels{};
+        // cells per label, label 0 is unused
+        std::vector<std::uint32_t> sizes{};
+        std::vector<std::uint32_t> free_labels{};
+        std::vector<std::uint32_t> queue{};
+
+        std::uint32_t new_label();
+        void free_label(std::uint32_t label);
+        // gives the region holding seed the label to, returns its size
+        std::uint32_t flood(std::size_t seed, std::uint32_t to);
+    };
+}
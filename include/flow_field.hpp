@@ -0,0 +1,69 @@
+#pragma once
+
+#include <array>
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "node.hpp"
+#include "grid.hpp"
+#include "open_list.hpp"
+#include "search_kernel.hpp"
+
+namespace pathfinder2 {
+    // a dijkstra map: the cost from every cell to one goal plus the step to take from every cell
+    // to get there, so any number of agents heading for the goal read their next move in O(1)
+    // instead of searching. moves follow the same rules as AStar.
+    //
+    // cell_changed() repairs the map after an edit: blocking a cell only recomputes the cells
+    // whose way to the goal went through it, opening one only spreads the costs it lowers. if an
+    // edit went unreported in between the map gets built again instead.
+    class FlowField {
+    public:
+        static constexpr int unreachable = INT_MAX;
+
+        FlowField() = default;
+        // the goal has to be in bounds
+        FlowField(const Grid &grid, Point goal);
+
+        bool empty() const { return dists.empty(); }
+        const GridShape &shape() const { return grid_shape; }
+        Point goal() const { return grid_shape.point(goal_ind); }
+        // the revision of the grid the map holds for, it's out of date on any other
+        std::uint64_t revision() const { return grid_revision; }
+
+        // cost to the goal from p, unreachable for obsticals and cells cut off from the goal
+        int distance(Point p) const { return dists[grid_shape.index(p)]; }
+
+        // the step to take from p towards the goal, {0, 0} at the goal and where it can't be reached
+        Point direction(Point p) const {
+            std::uint8_t dir = dirs[grid_shape.index(p)];
+            return dir == no_dir ? Point{0, 0} : Point{EightConnected::steps[dir].dx, EightConnected::steps[dir].dy};
+        }
+
+        // padded indices whose cost the last build or repair settled, in order
+        const std::vector<std::uint32_t> &settled() const { return settled_cells; }
+
+        // called after the cell at p was edited
+        void cell_changed(const Grid &grid, Point p);
+
+    private:
+        static constexpr std::uint8_t no_dir = UINT8_MAX;
+
+        GridShape grid_shape{};
+        std::uint64_t grid_revision = 0;
+        std::size_t goal_ind = 0;
+        std::vector<int> dists{};
+        // index into EightConnected::steps or no_dir
+        std::vector<std::uint8_t> dirs{};
+        std::array<std::ptrdiff_t, 8> offsets{};
+        IndexedBinaryHeap<int> open_list{};
+        std::vector<std::uint32_t> settled_cells{};
+        // cells a blocked cell cut off, scratch for cell_changed()
+        std::vector<std::uint32_t> cut_off{};
+
+        // cheapest way to ind through a neighbour that has a cost, queued if it's lower than now
+        void reconnect(const Grid &grid, std::size_t ind);
+        // dijkstra from whatever is queued
+        void propagate(const Grid &grid);
+    };
+}
@@ -0,0 +1,63 @@
+#pragma once
+
+#include <array>
+#include <memory>
+#include <string>
+#include <vector>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+
+namespace pathfinder2 {
+    namespace ui {
+        // every printable ascii glyph of a font rasterized once into a single texture. strings
+        // are drawn as one batch of textured quads, and the quads of the last few strings that
+        // were asked to be cached are kept so redrawing them is a single SDL_RenderGeometry call.
+        // once the buffers have grown to fit the longest string nothing is allocated per draw.
+        class GlyphAtlas {
+        public:
+            GlyphAtlas(SDL_Renderer &renderer, TTF_Font &font);
+            GlyphAtlas(const GlyphAtlas &other) = delete;
+            GlyphAtlas &operator=(const GlyphAtlas &other) = delete;
+
+            // size of text laid out with lines wrapped at wrap_width pixels
+            SDL_Point measure(const char *text, int wrap_width);
+
+            // draws text with its top left corner at (x, y) and returns the area it covers,
+            // cached text should be text that's going to be drawn again like fixed messages
+            SDL_Rect draw(SDL_Renderer &renderer, const char *text, int x, int y, int wrap_width,
+                    SDL_Color color, bool cache = false);
+
+        private:
+            static constexpr char first_glyph = ' ';
+            static constexpr char last_glyph = '~';
+            static constexpr std::size_t glyph_cnt = last_glyph - first_glyph + 1;
+            static constexpr std::size_t cache_size = 8;
+
+            struct Layout {
+                std::string text{};
+                int x = 0, y = 0, wrap_width = 0;
+                SDL_Color color{};
+                std::vector<SDL_Vertex> vertices{};
+                std::vector<int> indices{};
+                SDL_Rect bounds{};
+            };
+
+            std::unique_ptr<SDL_Texture, void (*)(SDL_Texture *)> atlas;
+            SDL_Point atlas_size{};
+            std::array<SDL_Rect, glyph_cnt> glyphs{};
+            int advance = 0;
+            int line_skip = 0;
+
+            std::array<Layout, cache_size> cache{};
+            std::size_t next_evicted = 0;
+            Layout scratch{};
+
+            // walks the text calling fn(glyph, x, y) with positions relative to the top left,
+            // returns the size of the laid out text
+            template <typename Fn>
+            SDL_Point lay_out(const char *text, int wrap_width, Fn &&fn);
+
+            void build(Layout &layout, const char *text, int x, int y, int wrap_width, SDL_Color color);
+        };
+    }
+}
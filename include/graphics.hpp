@@ -2,7 +2,11 @@
 
 #include <SDL_pixels.h>
 #include <string>
+#include <chrono>
+#include <optional>
+#include <cstdint>
 #include <SDL2/SDL.h>
+#include "maze.hpp"
 
 #define BASE_ASSET_PATH "../assets/"
 
@@ -21,12 +25,41 @@ namespace pathfinder2 {
         constexpr const char *suboptimal_texture_path = BASE_ASSET_PATH "04suboptimal.bmp";
         constexpr const char *optimal_texture_path  = BASE_ASSET_PATH "05optimal.bmp";
         
+        // colours of the textures above for when cells are too small to draw them
+        constexpr const SDL_Color walkable_color = SDL_Color { 211, 211, 211, 255 };
+        constexpr const SDL_Color obstical_color = SDL_Color { 102, 102, 153, 255 };
+        constexpr const SDL_Color start_color = SDL_Color { 102, 255, 255, 255 };
+        constexpr const SDL_Color end_color = SDL_Color { 255, 0, 102, 255 };
+        constexpr const SDL_Color suboptimal_color = SDL_Color { 255, 255, 102, 255 };
+        constexpr const SDL_Color optimal_color = SDL_Color { 153, 255, 102, 255 };
+        // arrows of the flow field overlay
+        constexpr const SDL_Color flow_color = SDL_Color { 51, 51, 51, 255 };
+
+        // below this many pixels a cell is a single colour instead of a texture
+        constexpr const double min_textured_cell_px = 8;
+
+        // ~60fps when the renderer can't wait for vsync
+        constexpr const std::chrono::microseconds frame_time{16667};
+        // time each frame gives the search in progress, the rest of the frame is drawing
+        constexpr const std::chrono::milliseconds search_budget{8};
+
         constexpr const char *font_asset_path = BASE_ASSET_PATH "PixelOperatorMono.ttf";
         constexpr const int font_asset_pt = 20;
         constexpr const SDL_Color font_color = SDL_Color { 255, 255, 255, 255 };
 
         constexpr const int frame_counter_pt = 20;
 
-        int run();
+        struct Options {
+            // MovingAI .map or binary map to load instead of generating a maze
+            std::string map_path{};
+            // 0 fits the grid to the window at the size of the textures
+            int grid_width = 0;
+            int grid_height = 0;
+            MazeAlgorithm maze = MazeAlgorithm::Backtracker;
+            // a random one when unset
+            std::optional<std::uint32_t> seed{};
+        };
+
+        int run(const Options &options = {});
     }
 }
@@ -0,0 +1,140 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include "node.hpp"
+
+namespace pathfinder2 {
+    // 1 bit per cell, indexed with the same (padded) cell indices as Grid
+    class BitGrid {
+    public:
+        BitGrid() = default;
+        explicit BitGrid(std::size_t bit_cnt) : words((bit_cnt + 63) / 64, 0), bit_cnt{bit_cnt} {}
+
+        std::size_t size() const { return bit_cnt; }
+        bool test(std::size_t ind) const { return (words[ind / 64] >> (ind % 64)) & 1; }
+        void set(std::size_t ind) { words[ind / 64] |= std::uint64_t{1} << (ind % 64); }
+        void reset(std::size_t ind) { words[ind / 64] &= ~(std::uint64_t{1} << (ind % 64)); }
+        void clear() { std::fill(words.begin(), words.end(), 0); }
+
+        const std::uint64_t *data() const { return words.data(); }
+        std::size_t word_count() const { return words.size(); }
+
+        bool operator==(const BitGrid &other) const = default;
+
+    private:
+        std::vector<std::uint64_t> words{};
+        std::size_t bit_cnt = 0;
+    };
+
+    // dimensions of a grid and the mapping between points and indices into its padded buffer
+    //
+    // cells are addressed either by Point (x, y) with 0 <= x < width(), 0 <= y < height(), or by
+    // their index into the padded buffer which is what the search algorithms work with.
+    class GridShape {
+    public:
+        GridShape() = default;
+        GridShape(int width, int height) : grid_width{width}, grid_height{height} {}
+
+        int width() const { return grid_width; }
+        int height() const { return grid_height; }
+
+        // distance between vertically adjacent cells in the padded buffer
+        std::size_t stride() const { return static_cast<std::size_t>(grid_width) + 2; }
+        std::size_t padded_size() const { return stride() * (static_cast<std::size_t>(grid_height) + 2); }
+        std::size_t cell_count() const { return static_cast<std::size_t>(grid_width) * grid_height; }
+
+        bool in_bounds(Point p) const {
+            return p.first >= 0 && p.second >= 0 && p.first < grid_width && p.second < grid_height;
+        }
+
+        std::size_t index(Point p) const {
+            return (static_cast<std::size_t>(p.second) + 1) * stride() + static_cast<std::size_t>(p.first) + 1;
+        }
+
+        Point point(std::size_t ind) const {
+            return {static_cast<int>(ind % stride()) - 1, static_cast<int>(ind / stride()) - 1};
+        }
+
+        // index offset to the neighbour in the direction dir
+        std::ptrdiff_t offset(Point dir) const {
+            return dir.second * static_cast<std::ptrdiff_t>(stride()) + dir.first;
+        }
+
+        bool operator==(const GridShape &other) const = default;
+
+    private:
+        int grid_width = 0;
+        int grid_height = 0;
+    };
+
+    // row major grid of nodes stored in one contiguous buffer. the grid is surrounded by a one
+    // cell wide border of obsticals, so any walkable cell can look at all 8 of its neighbours
+    // through a fixed index offset without bounds checking.
+    class Grid : public GridShape {
+    public:
+        static constexpr std::size_t npos = SIZE_MAX;
+
+        Grid() = default;
+        Grid(int width, int height, Node fill = Node::Walkable);
+
+        // a copy can be edited apart from the original, so it starts at a revision of its own
+        Grid(const Grid &other) : GridShape{other}, cells{other.cells} {}
+        Grid(Grid &&other) = default;
+        Grid &operator=(const Grid &other);
+        Grid &operator=(Grid &&other) = default;
+
+        const GridShape &shape() const { return *this; }
+
+        Node operator[](Point p) const { return cells[index(p)]; }
+        Node operator[](std::size_t ind) const { return cells[ind]; }
+        bool walkable(std::size_t ind) const { return cells[ind] != Node::Obstical; }
+
+        // p has to be in bounds, the border can't be written to
+        void set(Point p, Node node) {
+            Node &cell = cells[index(p)];
+            if ((cell == Node::Obstical) != (node == Node::Obstical)) {
+                cell_revision++;
+                last_edited = index(p);
+            }
+            cell = node;
+        }
+
+        void fill(Node node);
+
+        // row y from a bit packed row of obsticals (bit x % 64 of word x / 64 is column x) with
+        // every other cell walkable, counts as one edit like fill()
+        void assign_row(int y, const std::uint64_t *obsticals);
+
+        // goes up by one every time a cell turns walkable or blocked (fill() counts as one), so
+        // whatever was worked out from the obsticals at one revision holds as long as it stays
+        // the same. moving the start or end doesn't count. every grid and every copy starts at a
+        // revision no other grid has had, so it also tells grids of the same size apart.
+        std::uint64_t revision() const { return cell_revision; }
+
+        // whether the edit to p is the only one made since revision, for the algorithms that
+        // repair their state in cell_changed(). if it isn't, some edit went unreported and the
+        // state has to be worked out again.
+        bool follows(std::uint64_t revision, Point p) const {
+            return cell_revision == revision + 1 && last_edited == index(p);
+        }
+
+        // index of the first cell holding node or npos
+        std::size_t find(Node node) const;
+        std::size_t count(Node node) const;
+
+        const Node *data() const { return cells.data(); }
+
+        BitGrid obstacle_bitmap() const;
+
+    private:
+        std::vector<Node> cells{};
+        std::uint64_t cell_revision = first_revision();
+        // the cell of the latest revision, npos if it came from fill()
+        std::size_t last_edited = npos;
+
+        static std::uint64_t first_revision();
+    };
+}
@@ -0,0 +1,76 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <vector>
+#include "node.hpp"
+#include "grid.hpp"
+#include "search_kernel.hpp"
+
+namespace pathfinder2 {
+    // exact distances from a handful of landmark cells to every cell, for the ALT heuristic. by
+    // the triangle inequality |d(l, goal) - d(l, cell)| never overestimates d(cell, goal) for
+    // any landmark l, and on mazes it's a far better guess than the straight line. landmarks are
+    // picked farthest first so they end up spread around the edges of the map.
+    //
+    // the table only holds for the obsticals it was built on, matches() tells whether it still
+    // does. it can be saved next to a map so the dijkstras don't have to be rerun.
+    class LandmarkTable {
+    public:
+        static constexpr std::uint32_t unreachable = UINT32_MAX;
+        // more landmarks than this get cut down to it, every one costs 4 bytes per cell
+        static constexpr int max_landmark_cnt = 64;
+
+        LandmarkTable() = default;
+        LandmarkTable(const Grid &grid, int landmark_cnt);
+
+        bool empty() const { return landmark_cells.empty(); }
+        const GridShape &shape() const { return grid_shape; }
+        // padded indices
+        const std::vector<std::uint32_t> &landmarks() const { return landmark_cells; }
+
+        bool matches(const Grid &grid) const;
+
+        // lower bound on the cost between two padded indices
+        int lower_bound(std::size_t ind, std::size_t goal_ind) const {
+            const std::size_t cnt = landmark_cells.size();
+            const std::uint32_t *from = dists.data() + ind * cnt, *to = dists.data() + goal_ind * cnt;
+
+            int bound = 0;
+            for (std::size_t l = 0; l < cnt; l++) {
+                // landmarks in another region say nothing about these cells
+                if (from[l] == unreachable || to[l] == unreachable)
+                    continue;
+                int diff = static_cast<int>(from[l]) - static_cast<int>(to[l]);
+                bound = std::max(bound, diff < 0 ? -diff : diff);
+            }
+            return bound;
+        }
+
+        void save(std::ostream &out) const;
+        // throws std::runtime_error if in doesn't hold a table, or one that can't be right like
+        // too many landmarks or landmarks off of the grid
+        static LandmarkTable load(std::istream &in);
+
+    private:
+        GridShape grid_shape{};
+        std::vector<std::uint32_t> landmark_cells{};
+        // cell major, the distances of all landmarks to one cell sit next to each other
+        std::vector<std::uint32_t> dists{};
+        std::uint64_t obstacle_hash = 0;
+    };
+
+    // the larger of the octile distance and the landmark bound, for SearchKernel. the table has
+    // to match the grid being searched.
+    struct LandmarkHeuristic {
+        const LandmarkTable *table = nullptr;
+
+        template <typename Cost>
+        Cost estimate(Point p, std::size_t ind, Point goal, std::size_t goal_ind) const {
+            Cost octile = OctileHeuristic{}.estimate<Cost>(p, ind, goal, goal_ind);
+            return std::max(octile, static_cast<Cost>(table->lower_bound(ind, goal_ind)));
+        }
+    };
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstdint>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "node.hpp"
+#include "grid.hpp"
+
+namespace pathfinder2 {
+    // read only view of a bit packed obstical plane. every row starts on a fresh 64 bit word and
+    // a set bit is an obstical, bit x % 64 of word x / 64 holds column x.
+    class BitPlane {
+    public:
+        BitPlane() = default;
+        BitPlane(const std::uint64_t *words, int width, int height, std::size_t words_per_row) :
+            words{words}, plane_width{width}, plane_height{height}, row_words{words_per_row} {}
+
+        int width() const { return plane_width; }
+        int height() const { return plane_height; }
+        std::size_t words_per_row() const { return row_words; }
+
+        const std::uint64_t *row(int y) const { return words + static_cast<std::size_t>(y) * row_words; }
+        bool blocked(Point p) const { return row(p.second)[p.first / 64] >> (p.first % 64) & 1; }
+
+        // copies the plane into a grid, every cell is either Walkable or an Obstical
+        Grid to_grid() const;
+
+    private:
+        const std::uint64_t *words = nullptr;
+        int plane_width = 0;
+        int plane_height = 0;
+        std::size_t row_words = 0;
+    };
+
+    // binary map file: this header followed by the rows of a BitPlane. all fields are in the
+    // byte order of the machine that wrote it, loading one from the other byte order fails.
+    struct MapFileHeader {
+        char magic[8];
+        std::uint32_t version;
+        std::uint32_t width;
+        std::uint32_t height;
+        std::uint32_t words_per_row;
+    };
+
+    // a binary map file mapped into memory, nothing gets copied until it's turned into a grid
+    class MappedMap {
+    public:
+        explicit MappedMap(const std::string &path);
+        ~MappedMap();
+        MappedMap(const MappedMap &other) = delete;
+        MappedMap &operator=(const MappedMap &other) = delete;
+
+        const BitPlane &plane() const { return bit_plane; }
+
+    private:
+        void *mapping = nullptr;
+        std::size_t mapping_size = 0;
+        BitPlane bit_plane{};
+    };
+
+    // only the obsticals are written, start and end points are dropped
+    void write_binary_map(std::ostream &out, const Grid &grid);
+
+    // turns a MovingAI .map file into the binary format a row at a time, without a grid in between
+    void convert_movingai_map(std::istream &in, std::ostream &out);
+
+    // MovingAI benchmark .map file. '.', 'G' and 'S' are walkable, '@', 'O', 'T' and 'W' are
+    // obsticals. rows are read one at a time straight into the grid.
+    Grid read_movingai_map(std::istream &in);
+
+    // one line of a MovingAI .scen file
+    struct Scenario {
+        int bucket;
+        std::string map;
+        int map_width, map_height;
+        Point start, end;
+        // with a cost of sqrt(2) per diagonal and no cutting of corners, unlike the 10/14 costs
+        // and free corner cutting used here
+        double optimal_length;
+    };
+
+    std::vector<Scenario> read_movingai_scen(std::istream &in);
+
+    // picks the format by looking at the start of the file
+    Grid load_map(const std::string &path);
+}
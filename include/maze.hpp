@@ -1,7 +1,30 @@
 #pragma once
 
-#include "node.hpp"
+#include <cstdint>
+#include <ostream>
+#include "grid.hpp"
 
 namespace pathfinder2 {
-    void generate_maze(NodeMatrix &matrix);
+    // both algorithms carve out the cells at even coordinates and open up the walls between them,
+    // every cell ends up reachable from every other cell along exactly one route
+    enum class MazeAlgorithm {
+        // random depth first search, long winding corridors, needs the whole grid in memory
+        Backtracker,
+        // eller's algorithm, builds the maze one row at a time keeping only that row in memory
+        Eller,
+    };
+
+    struct MazeOptions {
+        std::uint32_t seed = 0;
+        MazeAlgorithm algorithm = MazeAlgorithm::Backtracker;
+    };
+
+    // every cell of the grid gets overwritten
+    void generate_maze(Grid &grid);
+    void generate_maze(Grid &grid, std::uint32_t seed);
+    void generate_maze(Grid &grid, const MazeOptions &options);
+
+    // writes a width x height maze to out as a MovingAI .map file. eller mazes are streamed
+    // straight to out so their size is only limited by the disk.
+    void write_maze(std::ostream &out, int width, int height, const MazeOptions &options);
 }
@@ -1,12 +1,11 @@
 #pragma once
 
 #include <cmath>
-#include <vector>
 #include <cstdint>
-#include <SDL2/SDL.h>
+#include <utility>
 
 namespace pathfinder2 {
-    enum class Node {
+    enum class Node : std::uint8_t {
         Walkable,
         Obstical,
         Start,
@@ -16,11 +15,12 @@ namespace pathfinder2 {
     Node &operator++(Node &rhs);
     Node &operator--(Node &rhs);
 
-    using NodeMatrix = std::vector<std::vector<Node>>;
     using Point = std::pair<int, int>;
-    using Color = SDL_Color;
 
     float dist(Point a, Point b);
 
     Point operator+(Point a, Point b);
+
+    // -1, 0 or 1, for the direction of a step between two points
+    constexpr int sign(int val) { return (val > 0) - (val < 0); }
 }
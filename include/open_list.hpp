@@ -0,0 +1,429 @@
+#pragma once
+
+#include <vector>
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <concepts>
+#include <cstdint>
+#include <type_traits>
+#include <utility>
+
+namespace pathfinder2 {
+    // what SearchKernel needs from its open list. IndexedBinaryHeap, RadixHeap and BucketQueue
+    // all have it, any of them can be picked per algorithm.
+    template <typename Queue, typename Key>
+    concept OpenList = requires(Queue queue, const Queue &const_queue, std::uint32_t node, Key key, std::size_t capacity) {
+        queue.reset(capacity);
+        queue.clear();
+        queue.push_or_decrease(node, key);
+        { queue.pop() } -> std::same_as<std::pair<std::uint32_t, Key>>;
+        { const_queue.empty() } -> std::convertible_to<bool>;
+        { const_queue.memory_bytes() } -> std::convertible_to<std::size_t>;
+    };
+
+    // the part of a key the monotone queues below order on: an integer key itself or the first
+    // element of a pair. the rest of a pair only breaks ties in IndexedBinaryHeap.
+    template <typename Key>
+    std::uint64_t key_priority(const Key &key) {
+        if constexpr (std::is_integral_v<Key>)
+            return static_cast<std::uint64_t>(key);
+        else
+            return static_cast<std::uint64_t>(key.first);
+    }
+
+    // binary min heap over node indices [0, capacity) that knows where every node sits, so a
+    // node can be pushed once and then have its key lowered in place instead of being pushed
+    // again. all operations are O(log n) and nothing is allocated after construction.
+    //
+    // the positions carry the generation they were written in, clear() starts a new generation
+    // instead of touching them so emptying the heap between searches is O(1).
+    template <typename Key>
+    class IndexedBinaryHeap {
+    public:
+        static constexpr std::uint32_t npos = UINT32_MAX;
+
+        IndexedBinaryHeap() = default;
+        explicit IndexedBinaryHeap(std::size_t capacity) { reset(capacity); }
+
+        // empties the heap and makes room for nodes [0, capacity)
+        void reset(std::size_t capacity) {
+            heap.clear();
+            heap.reserve(capacity);
+            positions.assign(capacity, {0, npos});
+            generation = 1;
+        }
+
+        // empties the heap in O(1) keeping its capacity
+        void clear() {
+            heap.clear();
+            // only once the generations wrap around do the stale positions have to go
+            if (++generation == 0) {
+                std::fill(positions.begin(), positions.end(), Slot{0, npos});
+                generation = 1;
+            }
+        }
+
+        std::size_t capacity() const { return positions.size(); }
+        std::size_t memory_bytes() const { return heap.capacity() * sizeof(heap[0]) + positions.capacity() * sizeof(positions[0]); }
+        bool empty() const { return heap.empty(); }
+        std::size_t size() const { return heap.size(); }
+        bool contains(std::uint32_t node) const { return position(node) != npos; }
+
+        // inserts node or lowers its key, a higher key for a node already queued is ignored
+        void push_or_decrease(std::uint32_t node, Key key) {
+            std::uint32_t pos = position(node);
+            if (pos == npos) {
+                pos = static_cast<std::uint32_t>(heap.size());
+                heap.push_back({key, node});
+                set_position(node, pos);
+            }
+            else if (key < heap[pos].first) {
+                heap[pos].first = key;
+            }
+            else {
+                return;
+            }
+            sift_up(pos);
+        }
+
+        // inserts node or moves it to its new key in either direction
+        void update(std::uint32_t node, Key key) {
+            std::uint32_t pos = position(node);
+            if (pos == npos || key < heap[pos].first) {
+                push_or_decrease(node, key);
+                return;
+            }
+            heap[pos].first = key;
+            sift_down(pos);
+        }
+
+        void remove(std::uint32_t node) {
+            std::uint32_t pos = position(node);
+            if (pos == npos)
+                return;
+            set_position(node, npos);
+
+            auto last = heap.back();
+            heap.pop_back();
+            if (pos == heap.size())
+                return;
+
+            heap[pos] = last;
+            set_position(last.second, pos);
+            sift_up(pos);
+            sift_down(position(last.second));
+        }
+
+        std::pair<std::uint32_t, Key> top() const {
+            return {heap.front().second, heap.front().first};
+        }
+
+        std::pair<std::uint32_t, Key> pop() {
+            auto min = heap.front();
+            set_position(min.second, npos);
+
+            auto last = heap.back();
+            heap.pop_back();
+            if (!heap.empty()) {
+                heap[0] = last;
+                set_position(last.second, 0);
+                sift_down(0);
+            }
+
+            return {min.second, min.first};
+        }
+
+    private:
+        struct Slot {
+            std::uint32_t generation, pos;
+        };
+
+        std::vector<std::pair<Key, std::uint32_t>> heap;
+        std::vector<Slot> positions;
+        std::uint32_t generation = 1;
+
+        std::uint32_t position(std::uint32_t node) const {
+            return positions[node].generation == generation ? positions[node].pos : npos;
+        }
+        void set_position(std::uint32_t node, std::uint32_t pos) { positions[node] = {generation, pos}; }
+
+        void sift_up(std::uint32_t pos) {
+            auto entry = heap[pos];
+            while (pos > 0) {
+                std::uint32_t parent = (pos - 1) / 2;
+                if (!(entry.first < heap[parent].first))
+                    break;
+                heap[pos] = heap[parent];
+                set_position(heap[pos].second, pos);
+                pos = parent;
+            }
+            heap[pos] = entry;
+            set_position(entry.second, pos);
+        }
+
+        void sift_down(std::uint32_t pos) {
+            auto entry = heap[pos];
+            std::uint32_t len = static_cast<std::uint32_t>(heap.size());
+            for (;;) {
+                std::uint32_t child = 2 * pos + 1;
+                if (child >= len)
+                    break;
+                if (child + 1 < len && heap[child + 1].first < heap[child].first)
+                    child++;
+                if (!(heap[child].first < entry.first))
+                    break;
+                heap[pos] = heap[child];
+                set_position(heap[pos].second, pos);
+                pos = child;
+            }
+            heap[pos] = entry;
+            set_position(entry.second, pos);
+        }
+    };
+
+    // the node bookkeeping the monotone queues share. they never move an entry to lower a key,
+    // a lowered node just gets a second entry and the one with the old key is skipped once it
+    // comes up. which key is current is stamped with a generation like in IndexedBinaryHeap.
+    template <typename Key>
+    class LazyOpenList {
+    public:
+        std::size_t capacity() const { return nodes.size(); }
+        bool empty() const { return live == 0; }
+        std::size_t size() const { return live; }
+        bool contains(std::uint32_t node) const { return nodes[node].generation == generation; }
+
+    protected:
+        struct Entry {
+            Key key;
+            std::uint32_t node;
+        };
+
+        struct NodeKey {
+            std::uint32_t generation;
+            Key key;
+        };
+
+        std::vector<NodeKey> nodes{};
+        std::uint32_t generation = 1;
+        std::size_t live = 0;
+
+        void reset_nodes(std::size_t capacity) {
+            nodes.assign(capacity, {0, Key{}});
+            generation = 1;
+            live = 0;
+        }
+
+        void clear_nodes() {
+            live = 0;
+            if (++generation == 0) {
+                std::fill(nodes.begin(), nodes.end(), NodeKey{0, Key{}});
+                generation = 1;
+            }
+        }
+
+        // true if the entry should be queued, false for a key that isn't lower
+        bool queue_key(std::uint32_t node, const Key &key) {
+            NodeKey &slot = nodes[node];
+            if (slot.generation != generation) {
+                slot = {generation, key};
+                live++;
+                return true;
+            }
+            if (!(key < slot.key))
+                return false;
+            slot.key = key;
+            return true;
+        }
+
+        bool stale(const Entry &entry) const {
+            const NodeKey &slot = nodes[entry.node];
+            return slot.generation != generation || !(slot.key == entry.key);
+        }
+
+        // the entry is the one being popped, later entries for the node are skipped
+        void take(const Entry &entry) {
+            nodes[entry.node].generation = 0;
+            live--;
+        }
+    };
+
+    // radix heap: a monotone priority queue for keys that never go below the last one popped,
+    // which holds for dijkstra and for A* with a consistent heuristic. an entry sits in the
+    // bucket of the highest bit its priority differs from the last popped one in, so pushes are
+    // O(1) and every entry moves down at most 64 times before it gets popped. priorities can't
+    // be negative. ties come out last in first out.
+    template <typename Key>
+    class RadixHeap : public LazyOpenList<Key> {
+        using Base = LazyOpenList<Key>;
+        using typename Base::Entry;
+
+    public:
+        RadixHeap() = default;
+        explicit RadixHeap(std::size_t capacity) { reset(capacity); }
+
+        void reset(std::size_t capacity) {
+            this->reset_nodes(capacity);
+            clear_buckets();
+        }
+
+        void clear() {
+            this->clear_nodes();
+            clear_buckets();
+        }
+
+        std::size_t memory_bytes() const {
+            std::size_t bytes = this->nodes.capacity() * sizeof(this->nodes[0]);
+            for (const auto &bucket : buckets)
+                bytes += bucket.capacity() * sizeof(Entry);
+            return bytes;
+        }
+
+        // inserts node or lowers its key, a higher key for a node already queued is ignored
+        void push_or_decrease(std::uint32_t node, Key key) {
+            if (this->queue_key(node, key))
+                buckets[bucket_for(key_priority(key))].push_back({key, node});
+        }
+
+        std::pair<std::uint32_t, Key> pop() {
+            for (;;) {
+                if (buckets[0].empty())
+                    redistribute();
+
+                Entry entry = buckets[0].back();
+                buckets[0].pop_back();
+                if (this->stale(entry))
+                    continue;
+
+                this->take(entry);
+                return {entry.node, entry.key};
+            }
+        }
+
+    private:
+        std::array<std::vector<Entry>, 65> buckets{};
+        std::uint64_t last = 0;
+
+        std::size_t bucket_for(std::uint64_t priority) const {
+            return priority == last ? 0 : 64 - static_cast<std::size_t>(std::countl_zero(priority ^ last));
+        }
+
+        void clear_buckets() {
+            for (auto &bucket : buckets)
+                bucket.clear();
+            last = 0;
+        }
+
+        // makes the lowest priority left the last one popped, which spreads the first bucket
+        // that isn't empty over the buckets below it and fills bucket 0
+        void redistribute() {
+            for (std::size_t i = 1; i < buckets.size(); i++) {
+                auto &bucket = buckets[i];
+                // stale entries get dropped here instead of being moved down
+                std::erase_if(bucket, [this](const Entry &entry) { return this->stale(entry); });
+                if (bucket.empty())
+                    continue;
+
+                last = UINT64_MAX;
+                for (const auto &entry : bucket)
+                    last = std::min(last, key_priority(entry.key));
+                for (const auto &entry : bucket)
+                    buckets[bucket_for(key_priority(entry.key))].push_back(entry);
+                bucket.clear();
+                return;
+            }
+        }
+    };
+
+    // bucket queue: one bucket per priority on a ring that covers the priorities between the
+    // lowest queued one and the highest, for keys that never go below the last one popped like
+    // RadixHeap. on a grid the f costs queued at once differ by at most a couple of steps so the
+    // ring stays small, it doubles when a push doesn't fit. ties come out last in first out.
+    template <typename Key>
+    class BucketQueue : public LazyOpenList<Key> {
+        using Base = LazyOpenList<Key>;
+        using typename Base::Entry;
+
+    public:
+        BucketQueue() = default;
+        explicit BucketQueue(std::size_t capacity) { reset(capacity); }
+
+        void reset(std::size_t capacity) {
+            this->reset_nodes(capacity);
+            buckets.assign(initial_buckets, {});
+            started = false;
+        }
+
+        void clear() {
+            this->clear_nodes();
+            for (auto &bucket : buckets)
+                bucket.clear();
+            started = false;
+        }
+
+        std::size_t memory_bytes() const {
+            std::size_t bytes = this->nodes.capacity() * sizeof(this->nodes[0]) + buckets.capacity() * sizeof(buckets[0]);
+            for (const auto &bucket : buckets)
+                bytes += bucket.capacity() * sizeof(Entry);
+            return bytes;
+        }
+
+        // inserts node or lowers its key, a higher key for a node already queued is ignored
+        void push_or_decrease(std::uint32_t node, Key key) {
+            if (!this->queue_key(node, key))
+                return;
+
+            std::uint64_t priority = key_priority(key);
+            if (!started) {
+                base = priority;
+                started = true;
+            }
+            else if (priority < base) {
+                // only before the first pop, the ring has to stretch down to cover it
+                std::uint64_t span = base + buckets.size() - priority;
+                if (span > buckets.size())
+                    grow(span);
+                base = priority;
+            }
+            if (priority - base >= buckets.size())
+                grow(priority - base + 1);
+            buckets[priority & (buckets.size() - 1)].push_back({key, node});
+        }
+
+        std::pair<std::uint32_t, Key> pop() {
+            for (;;) {
+                auto &bucket = buckets[base & (buckets.size() - 1)];
+                if (bucket.empty()) {
+                    base++;
+                    continue;
+                }
+
+                Entry entry = bucket.back();
+                bucket.pop_back();
+                if (this->stale(entry))
+                    continue;
+
+                this->take(entry);
+                return {entry.node, entry.key};
+            }
+        }
+
+    private:
+        static constexpr std::size_t initial_buckets = 64;
+
+        // a power of 2 long, priority p sits in bucket p % size
+        std::vector<std::vector<Entry>> buckets{};
+        // the lowest priority still queued is at least this
+        std::uint64_t base = 0;
+        bool started = false;
+
+        void grow(std::uint64_t span) {
+            std::vector<std::vector<Entry>> old = std::move(buckets);
+            buckets.assign(std::bit_ceil(span), {});
+            for (auto &bucket : old) {
+                for (const auto &entry : bucket)
+                    buckets[key_priority(entry.key) & (buckets.size() - 1)].push_back(entry);
+            }
+        }
+    };
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+#include "node.hpp"
+#include "grid.hpp"
+#include "pathing.hpp"
+
+namespace pathfinder2 {
+    struct PathCacheStats {
+        // the same start and end as a cached path
+        std::uint64_t hits = 0;
+        // the start on a cached path to the same end, answered with the rest of that path
+        std::uint64_t suffix_hits = 0;
+        std::uint64_t misses = 0;
+        // paths dropped because an edit could have changed them
+        std::uint64_t invalidated = 0;
+
+        // one line for the message bar
+        std::string summary() const;
+    };
+
+    // remembers the paths another algorithm found, so asking for the same start and end again on
+    // an unchanged map is a lookup instead of a search. every cached path holds for the revision
+    // of the grid it was found on, and since any stretch of a shortest path is a shortest path
+    // too, a start anywhere on a cached path to the same end gets the rest of that path.
+    //
+    // edits reported through cell_changed() only drop the paths they can affect: blocking a cell
+    // drops the paths through it or diagonally past it, opening one drops the paths it could be a
+    // shortcut for by the octile distance. edits it wasn't told about show up as a new revision
+    // and drop everything.
+    // reusing parts of paths assumes the algorithm finds shortest paths, hits don't expand any
+    // cells.
+    class CachedPathing : public PathingAlgorithm {
+    public:
+        static constexpr std::size_t default_capacity = 64;
+
+        explicit CachedPathing(std::unique_ptr<PathingAlgorithm> algorithm, std::size_t capacity = default_capacity);
+        SearchResult find_path(const Grid &grid) override;
+        void find_path(const Grid &grid, SearchResult &result) override;
+        SearchTask find_path_sliced(const Grid &grid, SearchResult &result) override;
+        void cell_changed(const Grid &grid, Point p) override;
+
+        const PathingAlgorithm &algorithm() const { return *inner; }
+        const PathCacheStats &stats() const { return counters; }
+        std::size_t size() const { return entries.size(); }
+        // whether the last path asked for came out of the cache
+        bool last_hit() const { return was_hit; }
+        void clear();
+
+    private:
+        struct Entry {
+            std::uint32_t start, end;
+            // -1 if there is no path
+            int cost;
+            // padded indices from the start to the end with the cost to get to each of them
+            std::vector<std::uint32_t> cells{};
+            std::vector<int> g_costs{};
+            // (cell, position on the path) sorted by cell, to find whether a cell is on the path
+            std::vector<std::pair<std::uint32_t, std::uint32_t>> by_cell{};
+            std::uint64_t last_used = 0;
+        };
+
+        std::unique_ptr<PathingAlgorithm> inner;
+        std::size_t capacity;
+        std::vector<Entry> entries{};
+        // (start << 32 | end) to the index into entries
+        std::unordered_map<std::uint64_t, std::size_t> by_endpoints{};
+        GridShape grid_shape{};
+        std::uint64_t grid_revision = 0;
+        std::uint64_t clock = 0;
+        PathCacheStats counters{};
+        bool was_hit = false;
+        std::vector<std::uint32_t> waypoints{};
+
+        // drops everything if the grid isn't the one the entries were found on anymore
+        void sync(const Grid &grid);
+        // fills result in from the cache, false on a miss
+        bool lookup(const Grid &grid, std::size_t start_ind, std::size_t end_ind, SearchResult &result);
+        void store(const Grid &grid, std::size_t start_ind, std::size_t end_ind, const SearchResult &result);
+        void drop(std::size_t ind);
+        // the rest of the path of entry from position from on as a result
+        void fill_result(const Entry &entry, std::size_t from, SearchResult &result);
+    };
+}
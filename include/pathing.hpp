@@ -1,29 +1,309 @@
 #pragma once
 
 #include "node.hpp"
-#include <string>
-#include <optional>
+#include "grid.hpp"
+#include "search_result.hpp"
+#include "search_task.hpp"
+#include "open_list.hpp"
+#include "search_kernel.hpp"
+#include "landmarks.hpp"
+#include "flow_field.hpp"
+#include "wavefront.hpp"
+#include <array>
+#include <atomic>
+#include <functional>
+#include <future>
+#include <thread>
+#include <vector>
+#include <memory>
+#include <utility>
+#include <cstdint>
 
 namespace pathfinder2 {
-    struct PathPoint {
-        Point point;
-        bool is_optimal;
-        std::optional<std::string> text;
-    };
-
     class PathingAlgorithm {
     public:
         virtual ~PathingAlgorithm() {};
         PathingAlgorithm(const PathingAlgorithm &other) = delete;
         PathingAlgorithm &operator=(const PathingAlgorithm &other) = delete;
-        virtual std::vector<PathPoint> find_path(const NodeMatrix &nodes) = 0;
+        virtual SearchResult find_path(const Grid &grid) = 0;
+
+        // same search but written over result, whose buffers get reused. algorithms that keep
+        // their scratch around override it so searching the same map again allocates nothing.
+        virtual void find_path(const Grid &grid, SearchResult &result) { result = find_path(grid); }
+
+        // the same search as a task to be run a slice at a time, which fills result in as it
+        // goes so the cells expanded so far can be drawn. algorithms that can't stop halfway do
+        // the whole search in the first slice. the grid and result have to outlive the task and
+        // the grid can't change until it is done or destroyed.
+        virtual SearchTask find_path_sliced(const Grid &grid, SearchResult &result);
+
+        // called after the cell at p was edited, algorithms that keep state between searches can
+        // use it to repair that state instead of starting over
+        virtual void cell_changed(const Grid &grid, Point p) { (void)grid; (void)p; }
     protected:
         PathingAlgorithm() = default;
     };
 
-    class AStar : public PathingAlgorithm {
+    // the search behind AStar, also used directly where only costs and paths are needed
+    using AStarWorkspace = SearchKernel<EightConnected, OctileHeuristic>;
+
+    // A* with any neighbourhood, heuristic and open list from search_kernel.hpp and
+    // open_list.hpp. the ones in the algorithm list are instantiated in astar.cpp.
+    template <typename Neighbourhood, typename Heuristic, template <typename> class Queue = IndexedBinaryHeap>
+    class GridAStar : public PathingAlgorithm {
+    public:
+        GridAStar() = default;
+        SearchResult find_path(const Grid &grid) override;
+        void find_path(const Grid &grid, SearchResult &result) override;
+        SearchTask find_path_sliced(const Grid &grid, SearchResult &result) override;
+    private:
+        SearchKernel<Neighbourhood, Heuristic, int, Queue> kernel{};
+        std::vector<std::uint32_t> waypoints{};
+    };
+
+    using AStar = GridAStar<EightConnected, OctileHeuristic>;
+    // moves between the four straight neighbours only
+    using AStar4 = GridAStar<FourConnected, ManhattanHeuristic>;
+    // no squeezing diagonally between obsticals, the rules of the MovingAI scenarios
+    using AStarNoCorners = GridAStar<EightConnectedNoCorners, OctileHeuristic>;
+    // the same search as AStar on the monotone open lists, same costs but ties can go another way
+    using AStarRadix = GridAStar<EightConnected, OctileHeuristic, RadixHeap>;
+    using AStarBuckets = GridAStar<EightConnected, OctileHeuristic, BucketQueue>;
+
+    extern template class GridAStar<EightConnected, OctileHeuristic>;
+    extern template class GridAStar<FourConnected, ManhattanHeuristic>;
+    extern template class GridAStar<EightConnectedNoCorners, OctileHeuristic>;
+    extern template class GridAStar<EightConnected, OctileHeuristic, RadixHeap>;
+    extern template class GridAStar<EightConnected, OctileHeuristic, BucketQueue>;
+
+    // A* with the landmark bound of a LandmarkTable on top of the octile heuristic. the
+    // table gets built on the first search, one loaded from disk can be handed in to skip that.
+    // once the obsticals no longer match it a new one is built on another thread, the searches
+    // until it's done only have the octile distance.
+    class AltAStar : public PathingAlgorithm {
+    public:
+        static constexpr int default_landmark_cnt = 8;
+
+        AltAStar() = default;
+        explicit AltAStar(LandmarkTable table) : table{std::move(table)} {}
+        SearchResult find_path(const Grid &grid) override;
+        void find_path(const Grid &grid, SearchResult &result) override;
+        SearchTask find_path_sliced(const Grid &grid, SearchResult &result) override;
+
+        const LandmarkTable &landmarks() const { return table; }
+    private:
+        LandmarkTable table{};
+        // the revision of the grid table was last found to match and the one last hashed
+        std::uint64_t table_revision = 0, checked_revision = 0;
+        std::future<LandmarkTable> rebuild{};
+        std::uint64_t rebuild_revision = 0;
+        SearchKernel<EightConnected, LandmarkHeuristic> kernel{};
+        std::vector<std::uint32_t> waypoints{};
+
+        // the table to search grid with, an empty one while a rebuild is still running
+        const LandmarkTable &prepare(const Grid &grid);
+    };
+
+    // A* with the steps of a Wavefront run from the end on top of the octile heuristic, which on
+    // mazes is close to the real cost. the wavefront also tells when the start is cut off from
+    // the end, then nothing gets searched. it's rerun when the end moves or an edit was reported
+    // through cell_changed(), edits that weren't reported or another grid show up in
+    // Grid::revision() and the plane gets built again.
+    class WavefrontAStar : public PathingAlgorithm {
+    public:
+        WavefrontAStar() = default;
+        SearchResult find_path(const Grid &grid) override;
+        void find_path(const Grid &grid, SearchResult &result) override;
+        SearchTask find_path_sliced(const Grid &grid, SearchResult &result) override;
+        void cell_changed(const Grid &grid, Point p) override;
+
+        const Wavefront &wavefront() const { return steps; }
+    private:
+        Wavefront steps{};
+        // the revision of the grid the plane has the obsticals of
+        std::uint64_t plane_revision = 0;
+        bool stale = true;
+        SearchKernel<EightConnected, WavefrontHeuristic> kernel{};
+        std::vector<std::uint32_t> waypoints{};
+
+        // runs the wavefront from the end if it's out of date and puts what that took in setup,
+        // returns false if it doesn't reach the start
+        bool prepare(const Grid &grid, std::size_t start_ind, std::size_t end_ind, SearchStats &setup);
+    };
+
+    // same movement rules and results as AStar but only expands jump points
+    class JumpPointSearch : public PathingAlgorithm {
+    public:
+        JumpPointSearch() = default;
+        SearchResult find_path(const Grid &grid) override;
+    };
+
+    // jump point search with the jump distances of every cell in all 8 directions precomputed,
+    // so jumps are a table lookup. the tables are rebuilt whenever Grid::revision() changes.
+    class JumpPointSearchPlus : public PathingAlgorithm {
+    public:
+        JumpPointSearchPlus() = default;
+        SearchResult find_path(const Grid &grid) override;
+    private:
+        std::vector<std::int32_t> jump_dists{};
+        // the grid the tables were computed for
+        GridShape tables_shape{};
+        std::uint64_t tables_revision = 0;
+
+        void precompute(const Grid &grid);
+    };
+
+    // lifelong planning A*: keeps its search tree between calls and when told about edited cells
+    // through cell_changed() only repairs the part of the tree the edit touched. an edit that
+    // wasn't reported, or another grid, shows up in Grid::revision() and the next search starts
+    // over, as it does when the start or the end moved.
+    class LifelongPlanningAStar : public PathingAlgorithm {
+    public:
+        LifelongPlanningAStar() = default;
+        SearchResult find_path(const Grid &grid) override;
+        void find_path(const Grid &grid, SearchResult &result) override;
+        void cell_changed(const Grid &grid, Point p) override;
+    private:
+        using Key = std::pair<int, int>;
+
+        GridShape planned_shape{};
+        // the revision of the grid the tree was repaired up to
+        std::uint64_t planned_revision = 0;
+        std::size_t start_ind = Grid::npos;
+        std::size_t end_ind = Grid::npos;
+        std::vector<int> g_costs{};
+        std::vector<int> rhs_costs{};
+        IndexedBinaryHeap<Key> open_list{};
+        // the cells this call expanded, only their bits get cleared on the next one
+        BitGrid expanded{};
+        std::vector<std::uint32_t> expanded_order{};
+        std::vector<std::uint32_t> waypoints{};
+        SearchStats search_stats{};
+
+        void reset(const Grid &grid);
+        Key calculate_key(const Grid &grid, std::size_t ind) const;
+        void update_cell(const Grid &grid, std::size_t ind);
+        void compute_shortest_path(const Grid &grid);
+    };
+
+    // hierarchical A*: the grid is cut into clusters and the crossings between neighbouring
+    // clusters become the nodes of a small abstract graph, with the costs between the crossings of
+    // a cluster precomputed. searches run on that graph and get refined one cluster at a time, so
+    // paths can come out a little longer than the shortest ones. edits reported through
+    // cell_changed() only rebuild the edited cluster and the crossings it shares with its
+    // neighbours, like LifelongPlanningAStar any other edit or another grid shows up in
+    // Grid::revision() and the whole graph gets built again.
+    class HPAStar : public PathingAlgorithm {
     public:
-        AStar() = default;
-        std::vector<PathPoint> find_path(const NodeMatrix &nodes) override;
+        HPAStar() = default;
+        SearchResult find_path(const Grid &grid) override;
+        void cell_changed(const Grid &grid, Point p) override;
+    private:
+        static constexpr int cluster_size = 16;
+
+        // a straight step from a cell of a cluster into the cell next to it in the neighbour
+        struct Transition {
+            std::uint32_t inside, outside;
+        };
+
+        struct Cluster {
+            // crossings into the cluster to the east and the one to the south
+            std::vector<Transition> east{}, south{};
+            // cells any crossing starts or ends at, on all four sides
+            std::vector<std::uint32_t> entrances{};
+            // cost between every pair of entrances without leaving the cluster, row major
+            std::vector<int> costs{};
+        };
+
+        struct Bounds {
+            int x0, y0, x1, y1;
+        };
+
+        GridShape built_shape{};
+        // the revision of the grid the graph has the crossings and costs of
+        std::uint64_t built_revision = 0;
+        int clusters_x = 0, clusters_y = 0;
+        std::vector<Cluster> clusters{};
+
+        // scratch for searches that stay inside of one cluster, indexed by the position in it
+        std::vector<int> local_costs{};
+        std::vector<std::int32_t> local_parents{};
+        IndexedBinaryHeap<int> local_open{};
+        SearchStats search_stats{};
+
+        void build(const Grid &grid);
+        Bounds bounds(std::size_t cluster) const;
+        std::size_t cluster_of(Point p) const;
+        std::size_t local_ind(const Bounds &bounds, Point p) const;
+        void find_transitions(const Grid &grid, std::size_t cluster);
+        void connect_entrances(const Grid &grid, std::size_t cluster);
+        void search_cluster(const Grid &grid, std::size_t cluster, std::size_t from);
+        // false if to can't be reached from from inside of their cluster
+        bool append_cluster_path(const Grid &grid, std::size_t from, std::size_t to, std::vector<std::uint32_t> &cells);
     };
+
+    // bidirectional A*: a search from the start on a second thread and one from the end on the
+    // calling thread. both order their cells by the average of the two octile distances (half
+    // of towards their target minus half of back to their root) instead of plain A*'s f cost, so
+    // the frontiers meet in the middle instead of both sweeping most of the way across. each
+    // publishes its costs and the key of the last cell it expanded, the cheapest meeting so far is
+    // a single atomic word and either stops once the two frontiers together can't beat it, so the
+    // paths are still the shortest. the helper thread is started by the first search and kept.
+    class BidirectionalAStar : public PathingAlgorithm {
+    public:
+        BidirectionalAStar() = default;
+        ~BidirectionalAStar() override;
+        SearchResult find_path(const Grid &grid) override;
+    private:
+        struct Meeting;
+
+        // the state of one direction, only written by the thread searching it. the costs and
+        // the last key are atomic since the other direction reads them while it runs.
+        struct Frontier {
+            std::vector<std::atomic<int>> g_costs{};
+            std::vector<std::int32_t> parents{};
+            BitGrid closed{};
+            IndexedBinaryHeap<std::pair<int, int>> open_list{};
+            std::atomic<int> last_key{0};
+            std::vector<std::uint32_t> touched{};
+            std::vector<std::uint32_t> expanded_order{};
+            SearchStats stats{};
+        };
+
+        GridShape shape{};
+        // forward from the start, then backward from the end
+        std::array<Frontier, 2> sides{};
+
+        // the forward side of every search runs on helper. a job is handed over by bumping
+        // jobs_started and is done once jobs_finished catches up, an empty job ends the thread.
+        std::thread helper{};
+        std::function<void()> helper_job{};
+        std::atomic<std::uint32_t> jobs_started{0};
+        std::atomic<std::uint32_t> jobs_finished{0};
+
+        void search_side(const Grid &grid, std::size_t side, std::size_t root_ind, std::size_t target_ind, Meeting &meeting);
+        void run_helper();
+    };
+
+    // reads paths off of a FlowField towards the end, which stays valid for any start. edits
+    // reported through cell_changed() repair the field in place and moving the end builds a new
+    // one. the cells the last build or repair settled show up as visited.
+    class FlowFieldSearch : public PathingAlgorithm {
+    public:
+        FlowFieldSearch() = default;
+        SearchResult find_path(const Grid &grid) override;
+        void cell_changed(const Grid &grid, Point p) override;
+
+        const FlowField &field() const { return flow; }
+    private:
+        FlowField flow{};
+    };
+
+    struct PathingAlgorithmInfo {
+        const char *name;
+        std::unique_ptr<PathingAlgorithm> (*make)();
+    };
+
+    // every available algorithm, the first one is the default
+    const std::vector<PathingAlgorithmInfo> &pathing_algorithms();
 }
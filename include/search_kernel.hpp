@@ -0,0 +1,295 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstdlib>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "node.hpp"
+#include "grid.hpp"
+#include "open_list.hpp"
+#include "search_stats.hpp"
+
+namespace pathfinder2 {
+    // one move a search can make, the cost is in tenths of a straight step
+    struct Step {
+        int dx, dy, cost;
+
+        constexpr bool diagonal() const { return dx != 0 && dy != 0; }
+        constexpr Point offset() const { return {dx, dy}; }
+    };
+
+    // neighbourhoods: the moves a search may make from a cell. the steps are fixed at compile
+    // time, only their index offsets depend on the stride of the grid being searched.
+
+    struct FourConnected {
+        static constexpr bool cut_corners = false;
+        static constexpr std::array<Step, 4> steps = {{
+            {0, 1, 10}, {1, 0, 10}, {0, -1, 10}, {-1, 0, 10},
+        }};
+    };
+
+    // diagonal steps may squeeze between two obsticals, the rules every algorithm here uses
+    struct EightConnected {
+        static constexpr bool cut_corners = true;
+        static constexpr std::array<Step, 8> steps = {{
+            {0, 1, 10}, {1, 0, 10}, {0, -1, 10}, {-1, 0, 10},
+            {-1, -1, 14}, {1, 1, 14}, {1, -1, 14}, {-1, 1, 14},
+        }};
+    };
+
+    // diagonal steps need both cells they pass between to be walkable, like in the MovingAI
+    // benchmarks
+    struct EightConnectedNoCorners {
+        static constexpr bool cut_corners = false;
+        static constexpr std::array<Step, 8> steps = EightConnected::steps;
+    };
+
+    // heuristics: lower bounds on the cost from p to the goal in the units of Step::cost. they
+    // get both the points and the padded indices so none of them has to divide to find either.
+    // manhattan only holds for FourConnected, the other two hold for every neighbourhood.
+
+    struct ManhattanHeuristic {
+        template <typename Cost>
+        Cost estimate(Point p, std::size_t, Point goal, std::size_t) const {
+            return static_cast<Cost>(10 * (std::abs(p.first - goal.first) + std::abs(p.second - goal.second)));
+        }
+    };
+
+    // exactly the cost without obsticals when diagonals are allowed
+    struct OctileHeuristic {
+        // also what the searches that don't go through SearchKernel use
+        static int distance(Point a, Point b) {
+            int dx = std::abs(a.first - b.first);
+            int dy = std::abs(a.second - b.second);
+            return 10 * std::max(dx, dy) + 4 * std::min(dx, dy);
+        }
+
+        template <typename Cost>
+        Cost estimate(Point p, std::size_t, Point goal, std::size_t) const {
+            return static_cast<Cost>(distance(p, goal));
+        }
+    };
+
+    // looser than octile and the only one that needs a square root, kept for comparison. a
+    // diagonal costs 14 and not 10 * sqrt(2), so the straight line distance gets scaled down to
+    // 7 * sqrt(2) per cell to stay under the step costs. floor(10 * sqrt(200)) is already 141 for
+    // 10 diagonal steps costing 140.
+    struct EuclideanHeuristic {
+        template <typename Cost>
+        Cost estimate(Point p, std::size_t, Point goal, std::size_t) const {
+            double dx = p.first - goal.first, dy = p.second - goal.second;
+            return static_cast<Cost>(std::sqrt(98 * (dx * dx + dy * dy)));
+        }
+    };
+
+    // A* over the padded grid with the moves, the heuristic, the cost type and the open list
+    // fixed at compile time, so every combination gets its own loop without calls through
+    // pointers. the open list is keyed on (f cost, heuristic), the monotone ones from
+    // open_list.hpp order on the f cost alone and are only right for consistent heuristics.
+    //
+    // the search state stays around between searches. every cell carries the generation of the
+    // search that last wrote it and anything older counts as unvisited, so a new search starts
+    // in O(1) and searching the same grid again allocates nothing.
+    template <typename Neighbourhood, typename Heuristic, typename Cost = int, template <typename> class Queue = IndexedBinaryHeap>
+    class SearchKernel {
+    public:
+        static_assert(std::is_integral_v<Cost> && std::is_signed_v<Cost>, "costs have to be signed integers");
+        static_assert(OpenList<Queue<std::pair<Cost, Cost>>, std::pair<Cost, Cost>>, "not an open list");
+
+        // cost of the cheapest path between two padded indices, -1 if there is none
+        Cost search(const Grid &grid, std::size_t start_ind, std::size_t end_ind, const Heuristic &heuristic = {}) {
+            begin(grid, start_ind, end_ind, heuristic);
+            advance(SIZE_MAX);
+            return cost();
+        }
+
+        // the same search a slice at a time: begin() sets it up and every advance() expands up
+        // to max_expansions more nodes, returning true once the search is over. the grid has to
+        // stay as it is until then.
+        void begin(const Grid &grid, std::size_t start_ind, std::size_t end_ind, const Heuristic &heuristic = {});
+        bool advance(std::size_t max_expansions);
+
+        // what the last search left behind, only valid until the next one
+
+        bool finished() const { return search_finished; }
+        // -1 if there is no path or the search isn't finished
+        Cost cost() const { return last_found ? cells[last_end].g_cost : -1; }
+        const std::vector<std::uint32_t> &expanded() const { return expanded_order; }
+        Cost g_cost(std::size_t ind) const { return cells[ind].stamp >= generation ? cells[ind].g_cost : unreached; }
+        const SearchStats &stats() const { return search_stats; }
+
+        // padded indices from the start to the end of the last search, empty if it found nothing
+        void path(std::vector<std::uint32_t> &waypoints) const;
+
+    private:
+        static constexpr Cost unreached = std::numeric_limits<Cost>::max();
+        static constexpr std::size_t step_cnt = Neighbourhood::steps.size();
+
+        // a stamp of generation means reached this search, generation + 1 expanded, anything
+        // lower is left over from an earlier one
+        struct CellState {
+            Cost g_cost;
+            std::int32_t parent;
+            std::uint32_t stamp;
+        };
+
+        GridShape shape{};
+        std::vector<CellState> cells{};
+        std::uint32_t generation = 0;
+        Queue<std::pair<Cost, Cost>> open_list{};
+        std::vector<std::uint32_t> expanded_order{};
+        SearchStats search_stats{};
+
+        // the search in progress
+        const Grid *grid = nullptr;
+        Heuristic heuristic{};
+        Point end_point{};
+        // offsets to the neighbours and, for diagonals, to the two cells they pass between
+        std::array<std::ptrdiff_t, step_cnt> offsets{}, corner_x{}, corner_y{};
+        std::size_t last_end = Grid::npos;
+        bool last_found = false;
+        bool search_finished = true;
+    };
+
+    template <typename Neighbourhood, typename Heuristic, typename Cost, template <typename> class Queue>
+    void SearchKernel<Neighbourhood, Heuristic, Cost, Queue>::begin(const Grid &grid, std::size_t start_ind, std::size_t end_ind,
+            const Heuristic &heuristic) {
+        PF2_PROBE_TIMER(probe_start);
+        search_stats = {};
+
+        // per cell search state, indexed like the padded grid so the border needs no bounds
+        // checks. it only gets allocated for a new grid size, otherwise bumping the generation
+        // forgets the last search
+
+        if (grid.shape() != shape) {
+            shape = grid.shape();
+            cells.assign(shape.padded_size(), {unreached, -1, 0});
+            open_list.reset(shape.padded_size());
+            generation = 0;
+        }
+        else {
+            open_list.clear();
+        }
+
+        // once in 2^31 searches the stamps run out and every cell gets reset for real
+        if (generation >= UINT32_MAX - 2) {
+            for (auto &cell : cells)
+                cell.stamp = 0;
+            generation = 0;
+        }
+        generation += 2;
+
+        PF2_PROBE_SET(search_stats, peak_scratch_bytes, cells.capacity() * sizeof(cells[0]) + open_list.memory_bytes());
+
+        expanded_order.clear();
+        this->grid = &grid;
+        this->heuristic = heuristic;
+        end_point = grid.point(end_ind);
+        last_end = end_ind;
+        last_found = false;
+        search_finished = false;
+
+        constexpr auto &steps = Neighbourhood::steps;
+        for (std::size_t i = 0; i < step_cnt; i++) {
+            offsets[i] = grid.offset({steps[i].dx, steps[i].dy});
+            corner_x[i] = grid.offset({steps[i].dx, 0});
+            corner_y[i] = grid.offset({0, steps[i].dy});
+        }
+
+        // open list is keyed on (f cost, heuristic) so ties go to the node closest to the end
+
+        cells[start_ind] = {0, -1, generation};
+        Cost start_h_cost = heuristic.template estimate<Cost>(grid.point(start_ind), start_ind, end_point, end_ind);
+        open_list.push_or_decrease(static_cast<std::uint32_t>(start_ind), {start_h_cost, start_h_cost});
+        PF2_PROBE(search_stats, pushed, 1);
+        PF2_PROBE(search_stats, heap_ops, 1);
+        PF2_PROBE_ELAPSED(search_stats, probe_start);
+    }
+
+    template <typename Neighbourhood, typename Heuristic, typename Cost, template <typename> class Queue>
+    bool SearchKernel<Neighbourhood, Heuristic, Cost, Queue>::advance(std::size_t max_expansions) {
+        if (search_finished)
+            return true;
+
+        PF2_PROBE_TIMER(probe_start);
+
+        // locals so the loop doesn't go back through this for every cell
+        constexpr auto &steps = Neighbourhood::steps;
+        const Grid &grid = *this->grid;
+        const std::size_t end_ind = last_end;
+        const std::uint32_t reached = generation, closed = generation + 1;
+        const auto offsets = this->offsets, corner_x = this->corner_x, corner_y = this->corner_y;
+
+        for (std::size_t expansions = 0; expansions < max_expansions; expansions++) {
+            if (open_list.empty()) {
+                search_finished = true;
+                break; // no possible way to endpoint
+            }
+
+            auto [current_ind, key] = open_list.pop();
+            cells[current_ind].stamp = closed;
+            expanded_order.push_back(current_ind);
+            PF2_PROBE(search_stats, heap_ops, 1);
+            PF2_PROBE(search_stats, expanded, 1);
+
+            if (current_ind == end_ind) {
+                last_found = true;
+                search_finished = true;
+                break;
+            }
+
+            const Cost current_g_cost = cells[current_ind].g_cost;
+            const Point current_point = grid.point(current_ind);
+
+            for (std::size_t i = 0; i < step_cnt; i++) {
+                std::size_t contender_ind = current_ind + offsets[i];
+
+                // the border is made of obsticals so this doubles as the bounds check
+                CellState &contender = cells[contender_ind];
+                if (!grid.walkable(contender_ind) || contender.stamp == closed)
+                    continue;
+
+                if constexpr (!Neighbourhood::cut_corners) {
+                    if (steps[i].diagonal() &&
+                            (!grid.walkable(current_ind + corner_x[i]) || !grid.walkable(current_ind + corner_y[i])))
+                        continue;
+                }
+
+                // reparents the contender if coming from the current node is cheaper
+                Cost g_cost = current_g_cost + static_cast<Cost>(steps[i].cost);
+                if (contender.stamp == reached && g_cost >= contender.g_cost)
+                    continue;
+
+                if (contender.stamp == reached)
+                    PF2_PROBE(search_stats, reparents, 1);
+                else
+                    PF2_PROBE(search_stats, pushed, 1);
+                PF2_PROBE(search_stats, heap_ops, 1);
+
+                contender = {g_cost, static_cast<std::int32_t>(current_ind), reached};
+                Point contender_point{current_point.first + steps[i].dx, current_point.second + steps[i].dy};
+                Cost h_cost = heuristic.template estimate<Cost>(contender_point, contender_ind, end_point, end_ind);
+                open_list.push_or_decrease(static_cast<std::uint32_t>(contender_ind), {g_cost + h_cost, h_cost});
+            }
+        }
+
+        PF2_PROBE_ELAPSED(search_stats, probe_start);
+        return search_finished;
+    }
+
+    template <typename Neighbourhood, typename Heuristic, typename Cost, template <typename> class Queue>
+    void SearchKernel<Neighbourhood, Heuristic, Cost, Queue>::path(std::vector<std::uint32_t> &waypoints) const {
+        waypoints.clear();
+        if (!last_found)
+            return;
+
+        for (auto ind = static_cast<std::int32_t>(last_end); ind != -1; ind = cells[ind].parent)
+            waypoints.push_back(ind);
+        std::reverse(waypoints.begin(), waypoints.end());
+    }
+}
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <optional>
+#include "node.hpp"
+#include "grid.hpp"
+#include "search_stats.hpp"
+
+namespace pathfinder2 {
+    // a straight or diagonal stretch of the path, steps cells long starting after from
+    struct PathSegment {
+        Point from;
+        std::int8_t dx, dy;
+        std::uint32_t steps;
+    };
+
+    // everything a search produced: the path as a list of segments, which cells were expanded
+    // and the costs of every expanded (or on path) cell. nothing is formatted up front,
+    // describe() builds the text for a single cell when the ui asks for it.
+    class SearchResult {
+    public:
+        SearchResult() = default;
+        explicit SearchResult(const GridShape &shape);
+
+        const GridShape &shape() const { return grid_shape; }
+
+        bool found() const { return path_found; }
+        const std::vector<PathSegment> &path() const { return segments; }
+
+        // number of cells on the path not counting the start
+        std::size_t path_length() const;
+        int path_cost() const;
+
+        bool visited(Point p) const { return grid_shape.in_bounds(p) && visited_bits.test(grid_shape.index(p)); }
+        bool on_path(Point p) const { return grid_shape.in_bounds(p) && path_bits.test(grid_shape.index(p)); }
+
+        // padded indices of the expanded cells in the order they were expanded
+        const std::vector<std::uint32_t> &visited_cells() const { return visited_order; }
+
+        int g_cost(Point p) const { return g_costs[grid_shape.index(p)]; }
+        int h_cost(Point p) const { return h_costs[grid_shape.index(p)]; }
+
+        const SearchStats &stats() const { return search_stats; }
+
+        // hover text for p, or nothing if the search never got to it
+        std::optional<std::string> describe(Point p) const;
+
+        // calls fn for every cell on the path from the start to the end, the start excluded
+        template <typename Fn>
+        void for_each_path_point(Fn &&fn) const {
+            for (const auto &segment : segments) {
+                Point cur = segment.from;
+                for (std::uint32_t i = 0; i < segment.steps; i++) {
+                    cur = cur + Point{segment.dx, segment.dy};
+                    fn(cur);
+                }
+            }
+        }
+
+        // used by the algorithms to fill the result in
+
+        SearchStats &stats() { return search_stats; }
+
+        // empties the result for a search on shape. the buffers are kept and only the cells the
+        // last search marked get cleared, so a result reused on the same map allocates nothing
+        void reset(const GridShape &shape);
+
+        void mark_visited(std::size_t ind, int g_cost, int h_cost);
+        void set_costs(std::size_t ind, int g_cost, int h_cost);
+
+        // waypoints are padded indices from the start to the end where every consecutive pair
+        // lies on a common row, column or diagonal
+        void set_path(const std::vector<std::uint32_t> &waypoints);
+
+    private:
+        GridShape grid_shape{};
+        BitGrid visited_bits{};
+        BitGrid path_bits{};
+        std::vector<std::uint32_t> visited_order{};
+        std::vector<int> g_costs{};
+        std::vector<int> h_costs{};
+        std::vector<PathSegment> segments{};
+        bool path_found = false;
+        SearchStats search_stats{};
+    };
+}
@@ -0,0 +1,46 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace pathfinder2 {
+    // what a single search cost, filled in by the algorithms through the probes below
+    struct SearchStats {
+        std::uint64_t expanded = 0;
+        // first time a node goes into the open list
+        std::uint64_t pushed = 0;
+        // every push, decrease, update, remove and pop on the open list
+        std::uint64_t heap_ops = 0;
+        // a node already queued found a cheaper parent
+        std::uint64_t reparents = 0;
+        // per search state the algorithm held while searching, the result not included
+        std::size_t peak_scratch_bytes = 0;
+        double elapsed_ms = 0;
+
+        // one line for the message bar
+        std::string summary() const;
+        std::string to_json() const;
+    };
+
+    // the probes only cost something when PATHFINDER2_SEARCH_STATS is defined, which the build
+    // does for debug builds or when asked to. otherwise they compile to nothing and the stats of
+    // every result stay zero. PF2_PROBE_ELAPSED adds to elapsed_ms so a search run in slices
+    // can time each one.
+#ifdef PATHFINDER2_SEARCH_STATS
+    constexpr bool search_stats_enabled = true;
+
+    #define PF2_PROBE(stats, counter, n) ((stats).counter += (n))
+    #define PF2_PROBE_SET(stats, field, value) ((stats).field = (value))
+    #define PF2_PROBE_TIMER(name) const auto name = std::chrono::steady_clock::now()
+    #define PF2_PROBE_ELAPSED(stats, name) \
+        ((stats).elapsed_ms += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - (name)).count())
+#else
+    constexpr bool search_stats_enabled = false;
+
+    #define PF2_PROBE(stats, counter, n) ((void)0)
+    #define PF2_PROBE_SET(stats, field, value) ((void)0)
+    #define PF2_PROBE_TIMER(name) ((void)0)
+    #define PF2_PROBE_ELAPSED(stats, name) ((void)0)
+#endif
+}
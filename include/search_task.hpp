@@ -0,0 +1,79 @@
+#pragma once
+
+#include <chrono>
+#include <coroutine>
+#include <exception>
+#include <utility>
+
+namespace pathfinder2 {
+    // a search running as a coroutine that gets resumed a slice at a time, so a caller with a
+    // frame to draw can give it a time budget and look at the partial result in between.
+    // destroying the task (or assigning a new one over it) cancels the search wherever it was.
+    class SearchTask {
+    public:
+        struct promise_type {
+            std::exception_ptr error{};
+
+            SearchTask get_return_object() { return SearchTask{std::coroutine_handle<promise_type>::from_promise(*this)}; }
+            // nothing runs until the first slice
+            std::suspend_always initial_suspend() noexcept { return {}; }
+            std::suspend_always final_suspend() noexcept { return {}; }
+            void return_void() {}
+            void unhandled_exception() { error = std::current_exception(); }
+        };
+
+        // searches give up their slice with co_await SearchTask::yield()
+        static std::suspend_always yield() { return {}; }
+
+        SearchTask() = default;
+        SearchTask(const SearchTask &other) = delete;
+        SearchTask &operator=(const SearchTask &other) = delete;
+        SearchTask(SearchTask &&other) noexcept : handle{std::exchange(other.handle, {})} {}
+        SearchTask &operator=(SearchTask &&other) noexcept {
+            if (this != &other) {
+                cancel();
+                handle = std::exchange(other.handle, {});
+            }
+            return *this;
+        }
+        ~SearchTask() { cancel(); }
+
+        // true once the search is over, or if there never was one
+        bool done() const { return !handle || handle.done(); }
+
+        // runs slices until the search is over or budget has passed, the search rethrows here
+        // whatever it threw. returns done().
+        bool run_for(std::chrono::steady_clock::duration budget) {
+            const auto deadline = std::chrono::steady_clock::now() + budget;
+            while (!done()) {
+                resume();
+                if (std::chrono::steady_clock::now() >= deadline)
+                    break;
+            }
+            return done();
+        }
+
+        // runs the whole search
+        void run() {
+            while (!done())
+                resume();
+        }
+
+        void cancel() {
+            if (handle)
+                handle.destroy();
+            handle = {};
+        }
+
+    private:
+        std::coroutine_handle<promise_type> handle{};
+
+        explicit SearchTask(std::coroutine_handle<promise_type> handle) : handle{handle} {}
+
+        void resume() {
+            handle.resume();
+            if (handle.promise().error)
+                std::rethrow_exception(std::exchange(handle.promise().error, {}));
+        }
+    };
+}
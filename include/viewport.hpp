@@ -0,0 +1,79 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include "node.hpp"
+#include "grid.hpp"
+
+namespace pathfinder2 {
+    namespace ui {
+        // range of cells [x0, x1) x [y0, y1)
+        struct CellRect {
+            int x0, y0, x1, y1;
+
+            int width() const { return x1 - x0; }
+            int height() const { return y1 - y0; }
+        };
+
+        // pan and zoom over a map that can be much bigger than the view. view pixels are relative
+        // to the top left of the grid area, cells are map coordinates. version() changes whenever
+        // the camera moves so renderers know when what they cached is stale.
+        class Camera {
+        public:
+            Camera(const GridShape &map, int view_width, int view_height, double native_cell_px);
+
+            double cell_px() const { return scale; }
+            std::uint64_t version() const { return camera_version; }
+
+            // cell under the view pixel, it might be outside of the map
+            Point cell_at(int view_x, int view_y) const;
+
+            // view pixel the top left corner of the cell lands on
+            int view_x(int cell_x) const;
+            int view_y(int cell_y) const;
+
+            // the cells that are at least partially visible, clipped to the map
+            CellRect visible() const;
+
+            // zooms by factor keeping the cell under the view pixel in place
+            void zoom_at(int view_x, int view_y, double factor);
+            void pan(double dx_px, double dy_px);
+
+            // largest zoom up to the native cell size that shows the whole map
+            void fit();
+
+        private:
+            GridShape map;
+            int view_width, view_height;
+            double min_scale, max_scale;
+            double scale = 1;
+            double left = 0, top = 0;
+            std::uint64_t camera_version = 0;
+
+            void clamp();
+        };
+
+        // obstical counts of every 2^level x 2^level block of the map for each level, so a zoomed
+        // out view can shade a pixel by how blocked the cells under it are without visiting them
+        class DensityPyramid {
+        public:
+            explicit DensityPyramid(const Grid &grid);
+
+            // highest level there is, level 0 is the grid itself
+            int levels() const { return static_cast<int>(counts.size()); }
+
+            // blocked fraction of the block at (block_x, block_y) on level scaled to [0, 255]
+            std::uint8_t density(int level, int block_x, int block_y) const;
+
+            // recounts the blocks above the cell after it was edited
+            void update(const Grid &grid, Point p);
+
+        private:
+            GridShape map;
+            std::vector<std::vector<std::uint32_t>> counts{};
+            std::vector<int> level_widths{};
+
+            std::uint32_t count(const Grid &grid, int level, int block_x, int block_y) const;
+        };
+    }
+}
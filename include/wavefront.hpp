@@ -0,0 +1,105 @@
+#pragma once
+
+#include <algorithm>
+#include <climits>
+#include <cstdint>
+#include <vector>
+#include "node.hpp"
+#include "grid.hpp"
+#include "map_io.hpp"
+#include "search_kernel.hpp"
+
+namespace pathfinder2 {
+    // breadth first search with every step costing 1, done on bits: the open cells are a bit
+    // packed plane and the whole frontier moves one step with a few shifts, ors and ands per 64
+    // cells, or per 256 with AVX2. it gives the exact number of steps from one source to every
+    // cell, either FourConnected or EightConnected (cutting corners like the algorithms do).
+    //
+    // steps times 10 never overestimates a path cost, so it's a heuristic for A* and an exact
+    // answer for 4-way costs. whatever it doesn't reach is cut off from the source.
+    class Wavefront {
+    public:
+        static constexpr int unreachable = INT_MAX;
+
+        // how a row of the frontier gets stepped, picked at runtime from what the cpu has
+        enum class Kernel { Scalar, SSE2, AVX2 };
+
+        static bool supported(Kernel kernel);
+        static Kernel best_kernel();
+        static const char *kernel_name(Kernel kernel);
+
+        Wavefront() = default;
+        // the kernel has to be supported
+        Wavefront(const Grid &grid, bool diagonal, Kernel kernel = best_kernel());
+        Wavefront(const BitPlane &plane, bool diagonal, Kernel kernel = best_kernel());
+
+        bool empty() const { return open_cells.empty(); }
+        const GridShape &shape() const { return grid_shape; }
+        bool diagonal() const { return diagonal_steps; }
+        Kernel kernel() const { return row_kernel; }
+        std::size_t memory_bytes() const;
+
+        // called after the cell at p was edited, the steps of the last run stay as they were
+        void cell_changed(const Grid &grid, Point p);
+
+        // steps from source to every cell. throws std::invalid_argument if source is out of
+        // bounds, a blocked source reaches nothing.
+        void run(Point source);
+
+        // what the last run found, steps can also be looked up by padded index like Grid
+        Point source() const { return source_point; }
+        int steps(Point p) const { return dists[grid_shape.index(p)]; }
+        int steps(std::size_t ind) const { return dists[ind]; }
+        bool reachable(Point p) const { return steps(p) != unreachable; }
+        // steps to the farthest cell reached
+        int radius() const { return max_steps; }
+
+    private:
+        using StepRow = bool (*)(const std::uint64_t *up, const std::uint64_t *row, const std::uint64_t *down,
+                const std::uint64_t *open, std::uint64_t *visited, std::uint64_t *next, std::size_t words);
+
+        GridShape grid_shape{};
+        bool diagonal_steps = true;
+        Kernel row_kernel = Kernel::Scalar;
+        StepRow step_row = nullptr;
+
+        // the planes have an empty row above and below the grid and an empty word on both ends
+        // of every row, so a row never has to check whether it's at an edge. the words in
+        // between are a multiple of 4 so the vector kernels have no tail.
+        std::size_t data_words = 0;
+        std::size_t row_words = 0;
+        std::vector<std::uint64_t> open_cells{};
+        std::vector<std::uint64_t> visited{};
+        std::vector<std::uint64_t> frontier{};
+        std::vector<std::uint64_t> next_frontier{};
+        // the rows that have frontier cells, in order
+        std::vector<int> frontier_rows{};
+        std::vector<int> next_rows{};
+
+        // padded like the grid
+        std::vector<int> dists{};
+        Point source_point{};
+        int max_steps = 0;
+
+        void allocate(const GridShape &shape, bool diagonal, Kernel kernel);
+        // first data word of row y, y can be -1 and height for the empty rows
+        std::size_t row_start(int y) const { return static_cast<std::size_t>(y + 1) * row_words + 1; }
+    };
+
+    // the larger of the octile distance and 10 per wavefront step, for SearchKernel. the
+    // wavefront has to have been run from the goal on the obsticals being searched, with
+    // diagonals for the eight connected neighbourhoods.
+    struct WavefrontHeuristic {
+        const Wavefront *wavefront = nullptr;
+
+        template <typename Cost>
+        Cost estimate(Point p, std::size_t ind, Point goal, std::size_t goal_ind) const {
+            Cost octile = OctileHeuristic{}.estimate<Cost>(p, ind, goal, goal_ind);
+            int steps = wavefront->steps(ind);
+            // cells the goal can't be reached from never end up on a path to it
+            if (steps == Wavefront::unreachable)
+                return octile;
+            return std::max(octile, static_cast<Cost>(10 * steps));
+        }
+    };
+}
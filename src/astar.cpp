@@ -1,148 +1,255 @@
 #include <stdexcept>
 #include <vector>
 #include <algorithm>
-#include <array>
-#include <iostream>
-#include <format>
+#include <chrono>
+#include <future>
 #include "pathing.hpp"
 #include "node.hpp"
+#include "grid.hpp"
+#include "search_kernel.hpp"
+#include "search_task.hpp"
 
 using namespace pathfinder2;
 
-int calculate_h_cost(std::vector<Point> search_nodes, std::vector<int> parent_nodes, int ind) {
-    int accum_dist = 0;
-    for (; parent_nodes[ind] != -1; ind = parent_nodes[ind]) {
-        auto current_node = search_nodes[ind];
-        auto parent_node = search_nodes[parent_nodes[ind]];
-        accum_dist += std::floor(10 * dist(current_node, parent_node));
+namespace {
+    // nodes a sliced search expands before it checks whether its time is up
+    constexpr std::size_t expansions_per_slice = 1024;
+
+    // what ALT searches with while its table is being rebuilt, no landmarks leaves the octile distance
+    const LandmarkTable no_landmarks{};
+
+    // copies the cells the kernel expanded since the first from of them into result
+    template <typename Kernel, typename Heuristic>
+    void mark_expanded(const Grid &grid, const Kernel &kernel, const Heuristic &heuristic, std::size_t end_ind, std::size_t from,
+            SearchResult &result) {
+        const Point end_point = grid.point(end_ind);
+        const auto &expanded = kernel.expanded();
+        for (std::size_t i = from; i < expanded.size(); i++) {
+            std::uint32_t ind = expanded[i];
+            result.mark_visited(ind, kernel.g_cost(ind), heuristic.template estimate<int>(grid.point(ind), ind, end_point, end_ind));
+        }
+    }
+
+    // setup is whatever an algorithm did before the kernel started, its time and scratch count
+    // towards the search
+    template <typename Kernel>
+    void finish_result(const Kernel &kernel, std::vector<std::uint32_t> &waypoints, SearchResult &result,
+            const SearchStats &setup = {}) {
+        result.stats() = kernel.stats();
+        PF2_PROBE(result.stats(), elapsed_ms, setup.elapsed_ms);
+        PF2_PROBE(result.stats(), peak_scratch_bytes, setup.peak_scratch_bytes);
+        (void)setup;
+        if (kernel.cost() < 0)
+            return; // no possible way to endpoint
+
+        kernel.path(waypoints);
+        result.set_path(waypoints);
     }
-    return accum_dist;
-}
 
-std::vector<PathPoint> AStar::find_path(const NodeMatrix &matrix) {
-    // linear search to find start and end nodes
-
-    Point start_point{-1, -1}, end_point{-1, -1};
-    int x = 0;
-    for (const auto &col : matrix) {
-        int y = 0;
-        for (const auto &node : col) {
-            if (node == Node::Start)
-                start_point = {x, y};
-            if (node == Node::End)
-                end_point = {x, y};
-            y++;
+    template <typename Kernel, typename Heuristic>
+    SearchTask sliced_search(const Grid &grid, Kernel &kernel, Heuristic heuristic, std::size_t start_ind, std::size_t end_ind,
+            std::vector<std::uint32_t> &waypoints, SearchResult &result, SearchStats setup = {}) {
+        result.reset(grid.shape());
+        kernel.begin(grid, start_ind, end_ind, heuristic);
+
+        for (std::size_t marked = 0;;) {
+            bool finished = kernel.advance(expansions_per_slice);
+            mark_expanded(grid, kernel, heuristic, end_ind, marked, result);
+            marked = kernel.expanded().size();
+            if (finished)
+                break;
+            co_await SearchTask::yield();
         }
-        x++;
+
+        finish_result(kernel, waypoints, result, setup);
     }
+}
+
+template <typename Neighbourhood, typename Heuristic, template <typename> class Queue>
+SearchResult GridAStar<Neighbourhood, Heuristic, Queue>::find_path(const Grid &grid) {
+    SearchResult result{};
+    find_path(grid, result);
+    return result;
+}
+
+template <typename Neighbourhood, typename Heuristic, template <typename> class Queue>
+void GridAStar<Neighbourhood, Heuristic, Queue>::find_path(const Grid &grid, SearchResult &result) {
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
+
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    const Heuristic heuristic{};
+    result.reset(grid.shape());
+    kernel.search(grid, start_ind, end_ind, heuristic);
+    mark_expanded(grid, kernel, heuristic, end_ind, 0, result);
+    finish_result(kernel, waypoints, result);
+}
+
+template <typename Neighbourhood, typename Heuristic, template <typename> class Queue>
+SearchTask GridAStar<Neighbourhood, Heuristic, Queue>::find_path_sliced(const Grid &grid, SearchResult &result) {
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
 
-    if (start_point.first < 0 || end_point.first < 0)
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
         throw std::invalid_argument("No start and/or end point");
 
-    // do algorithm
-
-    std::vector<Point> search_nodes{};
-    std::vector<int> parent_nodes{};
-
-    search_nodes.push_back(start_point);
-    parent_nodes.push_back(-1);
-
-    for (;;) {
-        Point lowest_f_cost_point{};
-        int lowest_f_cost_cost = -1, lowest_f_cost_parent = -1;
-
-        // search for node with lowest f cost
-        int search_nodes_len = static_cast<int>(search_nodes.size());
-        for (int i = 0; i < search_nodes_len; i++) {
-            auto current_node = search_nodes[i];
-
-            std::array<Point, 8> contenders = {
-                current_node + Point{0, 1},
-                current_node + Point{1, 0},
-                current_node + Point{0, -1},
-                current_node + Point{-1, 0},
-                current_node + Point{-1, -1},
-                current_node + Point{1, 1},
-                current_node + Point{1, -1},
-                current_node + Point{-1, 1},
-            };
-
-            for (auto contender : contenders) {
-                // dont search through already searched nodes 
-                if (std::find(std::begin(search_nodes), std::end(search_nodes), contender) != std::end(search_nodes))
-                    continue;
-
-                // bounds check and dont search if it's an obstical obv
-                if (contender.first < 0 || 
-                        contender.second < 0 || 
-                        contender.first >= static_cast<int>(matrix.size()) || 
-                        contender.second >= static_cast<int>(matrix[0].size()) ||
-                        matrix[contender.first][contender.second] == Node::Obstical)
-                    continue;
-
-                int h_cost_lhs = std::floor(10 * dist(contender, search_nodes[i]));
-                int h_cost_rhs = calculate_h_cost(search_nodes, parent_nodes, i);
-                int g_cost = std::floor(10 * dist(contender, end_point));
-                int f_cost = h_cost_lhs + h_cost_rhs + g_cost;
-                
-                if (f_cost < lowest_f_cost_cost || lowest_f_cost_cost == -1) {
-                    lowest_f_cost_point = contender;
-                    lowest_f_cost_parent = i;
-                    lowest_f_cost_cost = f_cost;
-                }
-            }
+    return sliced_search(grid, kernel, Heuristic{}, start_ind, end_ind, waypoints, result);
+}
+
+template class pathfinder2::GridAStar<EightConnected, OctileHeuristic>;
+template class pathfinder2::GridAStar<FourConnected, ManhattanHeuristic>;
+template class pathfinder2::GridAStar<EightConnectedNoCorners, OctileHeuristic>;
+template class pathfinder2::GridAStar<EightConnected, OctileHeuristic, RadixHeap>;
+template class pathfinder2::GridAStar<EightConnected, OctileHeuristic, BucketQueue>;
+
+const LandmarkTable &AltAStar::prepare(const Grid &grid) {
+    // a rebuild that finished since the last search takes over
+    if (rebuild.valid() && rebuild.wait_for(std::chrono::seconds{0}) == std::future_status::ready) {
+        table = rebuild.get();
+        table_revision = rebuild_revision;
+        checked_revision = 0;
+    }
+
+    if (grid.revision() == table_revision)
+        return table;
+
+    // there's nothing to go on for this map yet, so the first table is built right here
+    if (table.empty() || table.shape() != grid.shape()) {
+        rebuild = {};
+        table = LandmarkTable{grid, default_landmark_cnt};
+        table_revision = grid.revision();
+        return table;
+    }
+
+    // the bounds only hold for the obsticals the table was built on, which get hashed once per
+    // revision instead of on every search
+    if (grid.revision() != checked_revision) {
+        checked_revision = grid.revision();
+        if (table.matches(grid)) {
+            table_revision = grid.revision();
+            return table;
         }
-        
-        if (lowest_f_cost_cost < 0)
-            return {}; // no possible way to endpoint
-
-        search_nodes.push_back(lowest_f_cost_point);
-        parent_nodes.push_back(lowest_f_cost_parent);
-
-        // updates parents of surrounding nodes if the new node gets them a lower hcost
-        std::array<Point, 8> nodes_to_update = {
-            lowest_f_cost_point + Point{0, 1},
-            lowest_f_cost_point + Point{1, 0},
-            lowest_f_cost_point + Point{0, -1},
-            lowest_f_cost_point + Point{-1, 0},
-            lowest_f_cost_point + Point{-1, -1},
-            lowest_f_cost_point + Point{1, 1},
-            lowest_f_cost_point + Point{1, -1},
-            lowest_f_cost_point + Point{-1, 1},
-        };
-
-        for (auto cur_node : nodes_to_update) {
-            auto found = std::find(std::begin(search_nodes), std::end(search_nodes), cur_node);
-            if (found == std::end(search_nodes))
-                continue;
-            int ind = found - std::begin(search_nodes);
-
-            int h_cost_lhs_post  = std::floor(10 * dist(*found, lowest_f_cost_point));
-            int h_cost_rhs_post  = calculate_h_cost(search_nodes, parent_nodes, search_nodes.size() - 1);
-            int h_cost_rhs_pre  = calculate_h_cost(search_nodes, parent_nodes, ind);
-
-            if (h_cost_lhs_post + h_cost_rhs_post < h_cost_rhs_pre)
-                parent_nodes[ind] = search_nodes.size() - 1;
+
+        // the dijkstras run on a copy so the grid can keep changing in the meantime, if it does
+        // the finished table gets checked and rebuilt again
+        if (!rebuild.valid()) {
+            rebuild_revision = grid.revision();
+            rebuild = std::async(std::launch::async, [snapshot = grid] { return LandmarkTable{snapshot, default_landmark_cnt}; });
         }
+    }
+    return no_landmarks;
+}
+
+SearchResult AltAStar::find_path(const Grid &grid) {
+    SearchResult result{};
+    find_path(grid, result);
+    return result;
+}
+
+void AltAStar::find_path(const Grid &grid, SearchResult &result) {
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
 
-        // checks if we're done
-        if (lowest_f_cost_point == end_point)
-            break;
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    const LandmarkHeuristic heuristic{&prepare(grid)};
+    result.reset(grid.shape());
+    kernel.search(grid, start_ind, end_ind, heuristic);
+    mark_expanded(grid, kernel, heuristic, end_ind, 0, result);
+    finish_result(kernel, waypoints, result);
+}
+
+SearchTask AltAStar::find_path_sliced(const Grid &grid, SearchResult &result) {
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
+
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    // building the first table can't be sliced, it happens before the task starts
+    return sliced_search(grid, kernel, LandmarkHeuristic{&prepare(grid)}, start_ind, end_ind, waypoints, result);
+}
+
+bool WavefrontAStar::prepare(const Grid &grid, std::size_t start_ind, std::size_t end_ind, SearchStats &setup) {
+    PF2_PROBE_TIMER(probe_start);
+    const Point end_point = grid.point(end_ind);
+
+    // edits reported through cell_changed() are made to the plane in place, it's only built
+    // again for another grid or after an edit that wasn't reported
+    if (steps.empty() || steps.shape() != grid.shape() || grid.revision() != plane_revision) {
+        steps = Wavefront{grid, true};
+        plane_revision = grid.revision();
+        stale = true;
+    }
+    if (stale || steps.source() != end_point) {
+        steps.run(end_point);
+        stale = false;
     }
 
-    // paint searched and optimal nodes
+    PF2_PROBE_SET(setup, peak_scratch_bytes, steps.memory_bytes());
+    PF2_PROBE_ELAPSED(setup, probe_start);
+    (void)setup;
+    return steps.steps(start_ind) != Wavefront::unreachable;
+}
+
+SearchResult WavefrontAStar::find_path(const Grid &grid) {
+    SearchResult result{};
+    find_path(grid, result);
+    return result;
+}
 
-    std::vector<PathPoint> ret{};
-    
-    for (int i = 0; i < static_cast<int>(search_nodes.size()); i++) {
-        int h_cost = calculate_h_cost(search_nodes, parent_nodes, i);
-        int g_cost = std::floor(10 * dist(search_nodes[i], end_point));
-        auto msg = std::format("h_cost: {:3} g_cost: {:3} f_cost: {:3}", h_cost, g_cost, h_cost + g_cost);
-        ret.push_back({search_nodes[i], false, msg});
+void WavefrontAStar::find_path(const Grid &grid, SearchResult &result) {
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
+
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    SearchStats setup{};
+    if (!prepare(grid, start_ind, end_ind, setup)) {
+        result.reset(grid.shape());
+        result.stats() = setup;
+        return; // no possible way to endpoint
     }
 
-    for (int i = search_nodes.size() - 1; parent_nodes[i] != -1; i = parent_nodes[i])
-        ret[i].is_optimal = true;
+    const WavefrontHeuristic heuristic{&steps};
+    result.reset(grid.shape());
+    kernel.search(grid, start_ind, end_ind, heuristic);
+    mark_expanded(grid, kernel, heuristic, end_ind, 0, result);
+    finish_result(kernel, waypoints, result, setup);
+}
+
+SearchTask WavefrontAStar::find_path_sliced(const Grid &grid, SearchResult &result) {
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
+
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    // the wavefront is one pass over the plane per step, it happens before the task starts
+    // with the start cut off there's nothing to slice
+    SearchStats setup{};
+    if (!prepare(grid, start_ind, end_ind, setup))
+        return PathingAlgorithm::find_path_sliced(grid, result);
+
+    return sliced_search(grid, kernel, WavefrontHeuristic{&steps}, start_ind, end_ind, waypoints, result, setup);
+}
+
+void WavefrontAStar::cell_changed(const Grid &grid, Point p) {
+    if (steps.empty() || steps.shape() != grid.shape())
+        return;
+
+    // a plane that missed an edit before this one is left behind for prepare() to build again.
+    // the start or end moving doesn't change the revision.
+    if (grid.revision() != plane_revision) {
+        if (!grid.follows(plane_revision, p))
+            return;
+        plane_revision = grid.revision();
+    }
 
-    return ret;
+    steps.cell_changed(grid, p);
+    stale = true;
 }
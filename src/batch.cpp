@@ -0,0 +1,124 @@
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "batch.hpp"
+#include "pathing.hpp"
+#include "components.hpp"
+
+using namespace pathfinder2;
+
+// every worker starts out with a contiguous share of the queries cut into small ranges. it works
+// through its own deque from the back and once that's empty steals from the front of the
+// others, so a worker that got the long queries gets helped out instead of holding up the batch.
+// nothing gets queued after the start so finding every deque empty means the batch is done.
+
+namespace {
+    // small enough to balance, big enough that the deque locks don't show up
+    constexpr std::size_t range_size = 8;
+
+    using Range = std::pair<std::size_t, std::size_t>;
+
+    struct WorkQueue {
+        std::mutex mutex;
+        std::deque<Range> ranges;
+
+        bool pop(Range &range) {
+            std::lock_guard lock{mutex};
+            if (ranges.empty())
+                return false;
+            range = ranges.back();
+            ranges.pop_back();
+            return true;
+        }
+
+        bool steal(Range &range) {
+            std::lock_guard lock{mutex};
+            if (ranges.empty())
+                return false;
+            range = ranges.front();
+            ranges.pop_front();
+            return true;
+        }
+    };
+
+    // keeps the cells the path changes direction at
+    void to_corners(const Grid &grid, const std::vector<std::uint32_t> &waypoints, std::vector<Point> &corners) {
+        corners.clear();
+        for (std::size_t i = 0; i < waypoints.size(); i++) {
+            Point point = grid.point(waypoints[i]);
+            if (i > 0 && i + 1 < waypoints.size()) {
+                Point prev = grid.point(waypoints[i - 1]), next = grid.point(waypoints[i + 1]);
+                if (point.first - prev.first == next.first - point.first && point.second - prev.second == next.second - point.second)
+                    continue;
+            }
+            corners.push_back(point);
+        }
+    }
+
+    void solve(const Grid &grid, const ComponentIndex &components, const PathQuery &query, AStarWorkspace &workspace,
+            std::vector<std::uint32_t> &waypoints, PathAnswer &answer) {
+        // covers the end points being off the grid or on obsticals too
+        if (!components.connected(query.start, query.end))
+            return;
+
+        std::size_t start_ind = grid.index(query.start), end_ind = grid.index(query.end);
+
+        answer.cost = workspace.search(grid, start_ind, end_ind);
+        workspace.path(waypoints);
+        to_corners(grid, waypoints, answer.corners);
+    }
+}
+
+BatchResult pathfinder2::find_paths(const Grid &grid, std::span<const PathQuery> queries, unsigned thread_cnt) {
+    if (thread_cnt == 0)
+        thread_cnt = std::max(std::thread::hardware_concurrency(), 1u);
+
+    auto start = std::chrono::steady_clock::now();
+    BatchResult result{};
+
+    // labeling once costs about as much as a single search that fails, after that every
+    // unreachable query is turned down without searching
+    ComponentIndex components{grid};
+    result.answers.resize(queries.size());
+    result.threads = thread_cnt;
+
+    std::vector<WorkQueue> queues(thread_cnt);
+    const std::size_t range_cnt = (queries.size() + range_size - 1) / range_size;
+    for (std::size_t i = 0; i < range_cnt; i++) {
+        queues[i * thread_cnt / range_cnt].ranges.push_back(
+                {i * range_size, std::min((i + 1) * range_size, queries.size())});
+    }
+
+    auto work = [&](unsigned self) {
+        // scratch for this worker only, it grows to the grid on the first query and stays
+        AStarWorkspace workspace{};
+        std::vector<std::uint32_t> waypoints{};
+
+        for (;;) {
+            Range range;
+            bool got = queues[self].pop(range);
+            for (unsigned i = 1; !got && i < thread_cnt; i++)
+                got = queues[(self + i) % thread_cnt].steal(range);
+            if (!got)
+                return;
+
+            for (std::size_t q = range.first; q < range.second; q++)
+                solve(grid, components, queries[q], workspace, waypoints, result.answers[q]);
+        }
+    };
+
+    // the calling thread is the last worker
+    std::vector<std::thread> threads{};
+    for (unsigned i = 0; i + 1 < thread_cnt; i++)
+        threads.emplace_back(work, i);
+    work(thread_cnt - 1);
+    for (auto &thread : threads)
+        thread.join();
+
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
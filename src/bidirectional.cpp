@@ -0,0 +1,271 @@
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+#include "pathing.hpp"
+#include "search_kernel.hpp"
+
+using namespace pathfinder2;
+
+// with h_f the octile distance to the end and h_b the one to the start, the forward side orders
+// its cells by g + (h_f - h_b) / 2 and the backward side by g + (h_b - h_f) / 2. both potentials
+// are consistent and add up to 0, which makes every step cost the same amount more in either
+// direction, so the two searches are one dijkstra run from both ends on those costs. that
+// grows both frontiers at the same rate towards the middle, and once the lowest keys on both
+// sides add up to the best meeting nothing left can beat it. keys are doubled to stay integers.
+
+namespace {
+    constexpr auto &steps = EightConnected::steps;
+    constexpr std::size_t forward = 0, backward = 1;
+
+    // cost in the high half so comparing packed words compares costs first
+    std::uint64_t pack(int cost, std::size_t ind) {
+        return static_cast<std::uint64_t>(cost) << 32 | static_cast<std::uint32_t>(ind);
+    }
+
+    int heuristic(Point point, Point target) {
+        return OctileHeuristic::distance(point, target);
+    }
+}
+
+// the cheapest path either direction has seen so far, found where one of them reached a cell
+// the other had a cost for
+struct BidirectionalAStar::Meeting {
+    std::atomic<std::uint64_t> best{UINT64_MAX};
+    std::atomic<bool> stop{false};
+
+    int best_cost() const {
+        std::uint64_t packed = best.load(std::memory_order_relaxed);
+        return packed == UINT64_MAX ? INT_MAX : static_cast<int>(packed >> 32);
+    }
+
+    // lowers the best meeting to cost at ind unless the other thread got a cheaper one in first
+    void offer(int cost, std::size_t ind) {
+        std::uint64_t packed = pack(cost, ind);
+        std::uint64_t cur = best.load(std::memory_order_relaxed);
+        while (packed < cur && !best.compare_exchange_weak(cur, packed, std::memory_order_relaxed))
+            ;
+    }
+};
+
+BidirectionalAStar::~BidirectionalAStar() {
+    if (helper.joinable()) {
+        helper_job = nullptr;
+        jobs_started.fetch_add(1, std::memory_order_release);
+        jobs_started.notify_one();
+        helper.join();
+    }
+}
+
+void BidirectionalAStar::run_helper() {
+    for (std::uint32_t seen = 0;;) {
+        jobs_started.wait(seen, std::memory_order_acquire);
+        seen = jobs_started.load(std::memory_order_acquire);
+        if (!helper_job)
+            return;
+
+        helper_job();
+        jobs_finished.store(seen, std::memory_order_release);
+        jobs_finished.notify_one();
+    }
+}
+
+void BidirectionalAStar::search_side(const Grid &grid, std::size_t side, std::size_t root_ind, std::size_t target_ind,
+        Meeting &meeting) {
+    Frontier &self = sides[side];
+    const Frontier &other = sides[1 - side];
+    const Point root = grid.point(root_ind), target = grid.point(target_ind);
+
+    std::array<std::ptrdiff_t, steps.size()> offsets{};
+    for (std::size_t i = 0; i < steps.size(); i++)
+        offsets[i] = grid.offset(steps[i].offset());
+
+    while (!meeting.stop.load(std::memory_order_relaxed)) {
+        // once this side has run dry every cell it can reach that could be on a cheaper path
+        // has its final cost and any meeting through them has been offered
+        if (self.open_list.empty())
+            break;
+
+        // this side's keys only go up and the other side's last one is no more than anything it
+        // still has queued. a path through cells queued on both sides costs at least half their
+        // keys added up. the acquire pairs with the other side publishing its key after every
+        // meeting it offered before, so best_cost() has those.
+        auto [current_ind, key] = self.open_list.top();
+        int best_cost = meeting.best_cost();
+        if (best_cost != INT_MAX &&
+                static_cast<std::int64_t>(key.first) + other.last_key.load(std::memory_order_acquire) >= 2 * std::int64_t{best_cost})
+            break;
+
+        self.open_list.pop();
+        self.last_key.store(key.first, std::memory_order_release);
+        PF2_PROBE(self.stats, heap_ops, 1);
+
+        // queued before the best meeting got this cheap, it can't be on a cheaper path anymore.
+        // it stays open in case it gets reached cheaper later.
+        const int current_g_cost = self.g_costs[current_ind].load(std::memory_order_relaxed);
+        const Point current_point = grid.point(current_ind);
+        if (current_g_cost + key.second >= meeting.best_cost())
+            continue;
+
+        self.closed.set(current_ind);
+        self.expanded_order.push_back(current_ind);
+        PF2_PROBE(self.stats, expanded, 1);
+
+        for (std::size_t i = 0; i < steps.size(); i++) {
+            std::size_t contender_ind = current_ind + offsets[i];
+
+            // the border is made of obsticals so this doubles as the bounds check
+            if (!grid.walkable(contender_ind) || self.closed.test(contender_ind))
+                continue;
+
+            int g_cost = current_g_cost + steps[i].cost;
+            int old_g_cost = self.g_costs[contender_ind].load(std::memory_order_relaxed);
+            if (g_cost >= old_g_cost)
+                continue;
+
+            // the octile distance to the target still holds as a plain A* bound, so a cell that
+            // can't be on a path cheaper than the best meeting doesn't need to be queued
+            Point contender_point = current_point + steps[i].offset();
+            int to_target = heuristic(contender_point, target);
+            if (g_cost + to_target >= meeting.best_cost())
+                continue;
+
+            if (old_g_cost == INT_MAX) {
+                self.touched.push_back(static_cast<std::uint32_t>(contender_ind));
+                PF2_PROBE(self.stats, pushed, 1);
+            }
+            else {
+                PF2_PROBE(self.stats, reparents, 1);
+            }
+            PF2_PROBE(self.stats, heap_ops, 1);
+
+            // the cost goes out before the other side's gets read and the other side does the
+            // same, so when both reach a cell at once at least one of them sees the other
+            self.g_costs[contender_ind].store(g_cost, std::memory_order_seq_cst);
+            self.parents[contender_ind] = static_cast<std::int32_t>(current_ind);
+            int balance = to_target - heuristic(contender_point, root);
+            self.open_list.push_or_decrease(static_cast<std::uint32_t>(contender_ind), {2 * g_cost + balance, to_target});
+
+            // whatever the other side has for the cell is the cost of a real path to its end,
+            // even if it's still going to get lower
+            int other_g_cost = other.g_costs[contender_ind].load(std::memory_order_seq_cst);
+            if (other_g_cost != INT_MAX)
+                meeting.offer(g_cost + other_g_cost, contender_ind);
+        }
+    }
+
+    meeting.stop.store(true, std::memory_order_relaxed);
+}
+
+SearchResult BidirectionalAStar::find_path(const Grid &grid) {
+    PF2_PROBE_TIMER(probe_start);
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
+
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    // the per cell state is kept between searches like AStar's, only the cells the last search
+    // touched get put back
+
+    if (grid.shape() != shape) {
+        shape = grid.shape();
+        for (auto &side : sides) {
+            side.g_costs = std::vector<std::atomic<int>>(shape.padded_size());
+            for (auto &g_cost : side.g_costs)
+                g_cost.store(INT_MAX, std::memory_order_relaxed);
+            side.parents.assign(shape.padded_size(), -1);
+            side.closed = BitGrid{shape.padded_size()};
+            side.open_list.reset(shape.padded_size());
+            side.touched.clear();
+        }
+    }
+
+    for (auto &side : sides) {
+        for (auto ind : side.touched) {
+            side.g_costs[ind].store(INT_MAX, std::memory_order_relaxed);
+            side.parents[ind] = -1;
+            side.closed.reset(ind);
+        }
+        side.touched.clear();
+        side.open_list.clear();
+        side.expanded_order.clear();
+        side.stats = {};
+    }
+
+    // both roots are in place before the helper starts, so either side reaching the other's
+    // root is always noticed. a root's key is the octile distance between the two roots.
+    const std::array<std::size_t, 2> roots = {start_ind, end_ind};
+    const int root_key = heuristic(grid.point(start_ind), grid.point(end_ind));
+    for (std::size_t side = forward; side <= backward; side++) {
+        std::size_t root = roots[side];
+        sides[side].g_costs[root].store(0, std::memory_order_relaxed);
+        sides[side].last_key.store(root_key, std::memory_order_relaxed);
+        sides[side].touched.push_back(static_cast<std::uint32_t>(root));
+        sides[side].open_list.push_or_decrease(static_cast<std::uint32_t>(root), {root_key, root_key});
+        PF2_PROBE(sides[side].stats, pushed, 1);
+        PF2_PROBE(sides[side].stats, heap_ops, 1);
+    }
+
+    // the forward side goes to the helper, which only gets started once
+    Meeting meeting{};
+    helper_job = [&] { search_side(grid, forward, start_ind, end_ind, meeting); };
+    if (!helper.joinable())
+        helper = std::thread{[this] { run_helper(); }};
+    std::uint32_t job = jobs_started.fetch_add(1, std::memory_order_release) + 1;
+    jobs_started.notify_one();
+
+    search_side(grid, backward, end_ind, start_ind, meeting);
+    for (std::uint32_t done; (done = jobs_finished.load(std::memory_order_acquire)) != job;)
+        jobs_finished.wait(done, std::memory_order_acquire);
+
+    SearchResult result{grid.shape()};
+    for (std::size_t side = forward; side <= backward; side++) {
+        const Point target = grid.point(roots[1 - side]);
+        for (auto ind : sides[side].expanded_order)
+            result.mark_visited(ind, sides[side].g_costs[ind].load(std::memory_order_relaxed), heuristic(grid.point(ind), target));
+    }
+
+    // the two directions ran at once, so their times aren't added, the whole search is timed below
+    auto &stats = result.stats();
+    if constexpr (search_stats_enabled) {
+        for (const auto &side : sides) {
+            stats.expanded += side.stats.expanded;
+            stats.pushed += side.stats.pushed;
+            stats.heap_ops += side.stats.heap_ops;
+            stats.reparents += side.stats.reparents;
+            stats.peak_scratch_bytes += side.g_costs.size() * sizeof(side.g_costs[0]) +
+                    side.parents.capacity() * sizeof(side.parents[0]) +
+                    side.closed.word_count() * sizeof(std::uint64_t) + side.open_list.memory_bytes();
+        }
+    }
+
+    const int cost = meeting.best_cost();
+    if (cost == INT_MAX) {
+        PF2_PROBE_ELAPSED(stats, probe_start);
+        return result; // no possible way to endpoint
+    }
+
+    // both halves of the path hang off the meeting cell, the forward one gets turned around
+    const auto meet_ind = static_cast<std::int32_t>(meeting.best.load() & UINT32_MAX);
+    std::vector<std::uint32_t> waypoints{};
+    for (auto ind = meet_ind; ind != -1; ind = sides[forward].parents[ind])
+        waypoints.push_back(ind);
+    std::reverse(waypoints.begin(), waypoints.end());
+    for (auto ind = sides[backward].parents[meet_ind]; ind != -1; ind = sides[backward].parents[ind])
+        waypoints.push_back(ind);
+
+    for (auto ind : waypoints) {
+        int g_cost = sides[forward].g_costs[ind].load(std::memory_order_relaxed);
+        if (g_cost == INT_MAX)
+            g_cost = cost - sides[backward].g_costs[ind].load(std::memory_order_relaxed);
+        result.set_costs(ind, g_cost, cost - g_cost);
+    }
+    result.set_path(waypoints);
+
+    PF2_PROBE_ELAPSED(stats, probe_start);
+    return result;
+}
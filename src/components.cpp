@@ -0,0 +1,215 @@
+#include <algorithm>
+#include <array>
+#include <numeric>
+#include "components.hpp"
+
+using namespace pathfinder2;
+
+namespace {
+    // clockwise around a cell, every offset touches the ones next to it in the ring
+    constexpr std::array<Point, 8> ring = {{
+        {0, -1}, {1, -1}, {1, 0}, {1, 1}, {0, 1}, {-1, 1}, {-1, 0}, {-1, -1},
+    }};
+
+    std::uint32_t find_root(std::vector<std::uint32_t> &parents, std::uint32_t label) {
+        while (parents[label] != label) {
+            parents[label] = parents[parents[label]];
+            label = parents[label];
+        }
+        return label;
+    }
+}
+
+ComponentIndex::ComponentIndex(const Grid &grid) {
+    rebuild(grid);
+}
+
+void ComponentIndex::rebuild(const Grid &grid) {
+    grid_shape = grid.shape();
+    labels.assign(grid.padded_size(), none);
+    free_labels.clear();
+
+    // first pass hands out provisional labels looking only at the neighbours already visited
+    // (west and the three above) and records which of them touch, the second pass swaps every
+    // provisional label for its root and numbers the roots from 1
+
+    std::vector<std::uint32_t> parents{none};
+    const std::ptrdiff_t stride = grid.stride();
+    const std::array<std::ptrdiff_t, 4> visited_offsets = {-1, -stride - 1, -stride, -stride + 1};
+
+    for (int y = 0; y < grid.height(); y++) {
+        std::size_t ind = grid.index({0, y});
+        for (int x = 0; x < grid.width(); x++, ind++) {
+            if (!grid.walkable(ind))
+                continue;
+
+            std::uint32_t label = none;
+            for (auto offset : visited_offsets) {
+                std::uint32_t other = labels[ind + offset];
+                if (other == none)
+                    continue;
+                if (label == none) {
+                    label = other;
+                    continue;
+                }
+
+                std::uint32_t a = find_root(parents, label), b = find_root(parents, other);
+                if (a != b)
+                    parents[std::max(a, b)] = std::min(a, b);
+            }
+
+            if (label == none) {
+                label = static_cast<std::uint32_t>(parents.size());
+                parents.push_back(label);
+            }
+            labels[ind] = label;
+        }
+    }
+
+    std::vector<std::uint32_t> compact(parents.size(), none);
+    sizes.assign(1, 0);
+    for (std::uint32_t label = 1; label < parents.size(); label++) {
+        std::uint32_t root = find_root(parents, label);
+        if (compact[root] == none) {
+            compact[root] = static_cast<std::uint32_t>(sizes.size());
+            sizes.push_back(0);
+        }
+        compact[label] = compact[root];
+    }
+
+    for (auto &label : labels) {
+        if (label != none) {
+            label = compact[label];
+            sizes[label]++;
+        }
+    }
+}
+
+std::uint32_t ComponentIndex::new_label() {
+    if (!free_labels.empty()) {
+        std::uint32_t label = free_labels.back();
+        free_labels.pop_back();
+        return label;
+    }
+    sizes.push_back(0);
+    return static_cast<std::uint32_t>(sizes.size() - 1);
+}
+
+void ComponentIndex::free_label(std::uint32_t label) {
+    sizes[label] = 0;
+    free_labels.push_back(label);
+}
+
+std::uint32_t ComponentIndex::flood(std::size_t seed, std::uint32_t to) {
+    // cells still carrying the old label are the ones left to visit
+
+    const std::uint32_t from = labels[seed];
+    std::array<std::ptrdiff_t, ring.size()> offsets{};
+    for (std::size_t i = 0; i < ring.size(); i++)
+        offsets[i] = grid_shape.offset(ring[i]);
+
+    queue.clear();
+    queue.push_back(static_cast<std::uint32_t>(seed));
+    labels[seed] = to;
+
+    for (std::size_t head = 0; head < queue.size(); head++) {
+        for (auto offset : offsets) {
+            std::size_t next = queue[head] + offset;
+            if (labels[next] == from) {
+                labels[next] = to;
+                queue.push_back(static_cast<std::uint32_t>(next));
+            }
+        }
+    }
+
+    return static_cast<std::uint32_t>(queue.size());
+}
+
+void ComponentIndex::cell_changed(const Grid &grid, Point p) {
+    if (grid.shape() != grid_shape) {
+        rebuild(grid);
+        return;
+    }
+
+    const std::size_t ind = grid.index(p);
+    const bool walkable = grid.walkable(ind);
+    if (walkable == (labels[ind] != none))
+        return; // start and end points are as walkable as any cell
+
+    if (walkable) {
+        // joins every region around it, the biggest one keeps its label
+
+        std::uint32_t keep = none;
+        for (auto offset : ring) {
+            std::uint32_t label = labels[ind + grid.offset(offset)];
+            if (label != none && (keep == none || sizes[label] > sizes[keep]))
+                keep = label;
+        }
+
+        if (keep == none)
+            keep = new_label();
+
+        for (auto offset : ring) {
+            std::size_t neighbour = ind + grid.offset(offset);
+            std::uint32_t label = labels[neighbour];
+            if (label != none && label != keep) {
+                sizes[keep] += flood(neighbour, keep);
+                free_label(label);
+            }
+        }
+
+        labels[ind] = keep;
+        sizes[keep]++;
+        return;
+    }
+
+    const std::uint32_t old_label = labels[ind];
+    labels[ind] = none;
+    sizes[old_label]--;
+
+    // neighbours next to each other in the ring touch, and so do the straight ones two apart
+    // since corners can be cut. if the open neighbours are all linked up that way they stay
+    // connected without the cell.
+
+    std::array<bool, ring.size()> open{};
+    for (std::size_t i = 0; i < ring.size(); i++)
+        open[i] = labels[ind + grid.offset(ring[i])] != none;
+
+    std::array<std::size_t, ring.size()> group{};
+    std::iota(group.begin(), group.end(), 0);
+    auto root = [&](std::size_t i) {
+        while (group[i] != i)
+            i = group[i];
+        return i;
+    };
+    auto link = [&](std::size_t a, std::size_t b) {
+        if (open[a] && open[b])
+            group[root(a)] = root(b);
+    };
+    for (std::size_t i = 0; i < ring.size(); i++) {
+        link(i, (i + 1) % ring.size());
+        if (i % 2 == 0)
+            link(i, (i + 2) % ring.size());
+    }
+
+    std::size_t groups = 0;
+    for (std::size_t i = 0; i < ring.size(); i++)
+        groups += open[i] && root(i) == i;
+
+    if (groups == 0) {
+        free_label(old_label);
+        return;
+    }
+    if (groups == 1)
+        return;
+
+    // it might have split, every neighbour the floods haven't reached yet starts a new region
+    for (auto offset : ring) {
+        std::size_t neighbour = ind + grid.offset(offset);
+        if (labels[neighbour] == old_label) {
+            std::uint32_t label = new_label();
+            sizes[label] = flood(neighbour, label);
+        }
+    }
+    free_label(old_label);
+}
@@ -0,0 +1,187 @@
+#include <array>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+#include "flow_field.hpp"
+#include "pathing.hpp"
+
+using namespace pathfinder2;
+
+namespace {
+    constexpr auto &steps = EightConnected::steps;
+
+    // index of the step going back the way steps[i] came
+    constexpr std::array<std::uint8_t, 8> opposite = [] {
+        std::array<std::uint8_t, 8> out{};
+        for (std::size_t i = 0; i < steps.size(); i++) {
+            for (std::size_t j = 0; j < steps.size(); j++) {
+                if (steps[j].dx == -steps[i].dx && steps[j].dy == -steps[i].dy)
+                    out[i] = static_cast<std::uint8_t>(j);
+            }
+        }
+        return out;
+    }();
+}
+
+FlowField::FlowField(const Grid &grid, Point goal) :
+    grid_shape{grid.shape()},
+    grid_revision{grid.revision()},
+    goal_ind{grid.index(goal)},
+    dists(grid.padded_size(), unreachable),
+    dirs(grid.padded_size(), no_dir),
+    open_list{grid.padded_size()}
+{
+    for (std::size_t i = 0; i < steps.size(); i++)
+        offsets[i] = grid.offset({steps[i].dx, steps[i].dy});
+
+    if (grid.walkable(goal_ind)) {
+        dists[goal_ind] = 0;
+        open_list.push_or_decrease(static_cast<std::uint32_t>(goal_ind), 0);
+    }
+    propagate(grid);
+}
+
+void FlowField::reconnect(const Grid &grid, std::size_t ind) {
+    if (!grid.walkable(ind))
+        return;
+
+    // steps cost the same both ways, so the way out of ind through a neighbour costs what the
+    // neighbour's way in does
+    bool lowered = false;
+    for (std::size_t i = 0; i < steps.size(); i++) {
+        std::size_t neighbour_ind = ind + offsets[i];
+        if (dists[neighbour_ind] == unreachable)
+            continue;
+
+        int cost = dists[neighbour_ind] + steps[i].cost;
+        if (cost < dists[ind]) {
+            dists[ind] = cost;
+            dirs[ind] = static_cast<std::uint8_t>(i);
+            lowered = true;
+        }
+    }
+
+    if (lowered)
+        open_list.push_or_decrease(static_cast<std::uint32_t>(ind), dists[ind]);
+}
+
+void FlowField::propagate(const Grid &grid) {
+    while (!open_list.empty()) {
+        auto [ind, dist] = open_list.pop();
+        settled_cells.push_back(ind);
+
+        for (std::size_t i = 0; i < steps.size(); i++) {
+            std::size_t neighbour_ind = ind + offsets[i];
+
+            // the border is made of obsticals so this doubles as the bounds check
+            if (!grid.walkable(neighbour_ind))
+                continue;
+
+            int cost = dist + steps[i].cost;
+            if (cost < dists[neighbour_ind]) {
+                dists[neighbour_ind] = cost;
+                dirs[neighbour_ind] = opposite[i];
+                open_list.push_or_decrease(static_cast<std::uint32_t>(neighbour_ind), cost);
+            }
+        }
+    }
+}
+
+void FlowField::cell_changed(const Grid &grid, Point p) {
+    // the start or end moving doesn't change the revision and leaves the costs as they are
+    if (grid.revision() != grid_revision) {
+        if (!grid.follows(grid_revision, p)) {
+            *this = FlowField{grid, goal()};
+            return;
+        }
+        grid_revision = grid.revision();
+    }
+
+    const std::size_t ind = grid.index(p);
+    settled_cells.clear();
+
+    // an opened cell takes the cheapest way through its neighbours and passes it on to every
+    // cell that gets cheaper through it. a cell that stayed walkable can't get cheaper.
+    if (grid.walkable(ind)) {
+        if (ind == goal_ind && dists[ind] != 0) {
+            dists[ind] = 0;
+            dirs[ind] = no_dir;
+            open_list.push_or_decrease(static_cast<std::uint32_t>(ind), 0);
+        }
+        else {
+            reconnect(grid, ind);
+        }
+        propagate(grid);
+        return;
+    }
+
+    if (dists[ind] == unreachable)
+        return;
+
+    // everything whose way to the goal went through the blocked cell loses its cost. the rest
+    // keeps theirs, blocking a cell can't make a way that avoided it any longer.
+
+    cut_off.clear();
+    cut_off.push_back(static_cast<std::uint32_t>(ind));
+    dists[ind] = unreachable;
+    dirs[ind] = no_dir;
+
+    for (std::size_t head = 0; head < cut_off.size(); head++) {
+        std::size_t cur = cut_off[head];
+        for (std::size_t i = 0; i < steps.size(); i++) {
+            std::size_t neighbour_ind = cur + offsets[i];
+            if (dists[neighbour_ind] != unreachable && dirs[neighbour_ind] == opposite[i]) {
+                dists[neighbour_ind] = unreachable;
+                dirs[neighbour_ind] = no_dir;
+                cut_off.push_back(static_cast<std::uint32_t>(neighbour_ind));
+            }
+        }
+    }
+
+    // the cells on the edge of the hole take the cheapest way around it and it flows back in
+    for (auto cut : cut_off)
+        reconnect(grid, cut);
+    propagate(grid);
+}
+
+void FlowFieldSearch::cell_changed(const Grid &grid, Point p) {
+    if (!flow.empty() && flow.shape() == grid.shape())
+        flow.cell_changed(grid, p);
+}
+
+SearchResult FlowFieldSearch::find_path(const Grid &grid) {
+    PF2_PROBE_TIMER(probe_start);
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
+
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    // edits that weren't reported show up as another revision
+    const Point start_point = grid.point(start_ind), end_point = grid.point(end_ind);
+    if (flow.empty() || flow.shape() != grid.shape() || flow.revision() != grid.revision() || flow.goal() != end_point)
+        flow = FlowField{grid, end_point};
+
+    SearchResult result{grid.shape()};
+    for (auto ind : flow.settled())
+        result.mark_visited(ind, 0, flow.distance(grid.point(ind)));
+    PF2_PROBE_SET(result.stats(), expanded, flow.settled().size());
+
+    const int cost = flow.distance(start_point);
+    if (cost == FlowField::unreachable) {
+        PF2_PROBE_ELAPSED(result.stats(), probe_start);
+        return result; // no possible way to endpoint
+    }
+
+    // every cell on the way knows its exact cost to the end
+    std::vector<std::uint32_t> waypoints{static_cast<std::uint32_t>(start_ind)};
+    for (Point cur = start_point; cur != end_point;) {
+        cur = cur + flow.direction(cur);
+        waypoints.push_back(static_cast<std::uint32_t>(grid.index(cur)));
+        result.set_costs(grid.index(cur), cost - flow.distance(cur), flow.distance(cur));
+    }
+    result.set_path(waypoints);
+
+    PF2_PROBE_ELAPSED(result.stats(), probe_start);
+    return result;
+}
@@ -0,0 +1,164 @@
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+#include <stdexcept>
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include "glyph_atlas.hpp"
+
+using namespace pathfinder2::ui;
+
+GlyphAtlas::GlyphAtlas(SDL_Renderer &renderer, TTF_Font &font) :
+    atlas{nullptr, [](SDL_Texture *texture) { SDL_DestroyTexture(texture); }}
+{
+    // glyphs are rendered white so the vertex color decides what color the text ends up
+
+    constexpr SDL_Color white{255, 255, 255, 255};
+    std::array<SDL_Surface *, glyph_cnt> glyph_surfs{};
+    line_skip = TTF_FontLineSkip(&font);
+
+    for (std::size_t i = 0; i < glyphs.size(); i++) {
+        auto ch = static_cast<Uint16>(first_glyph + i);
+        glyph_surfs[i] = TTF_RenderGlyph_Solid(&font, ch, white);
+
+        int glyph_advance = 0;
+        TTF_GlyphMetrics(&font, ch, nullptr, nullptr, nullptr, nullptr, &glyph_advance);
+        advance = std::max(advance, glyph_advance);
+
+        if (glyph_surfs[i] != nullptr) {
+            glyphs[i] = {atlas_size.x, 0, glyph_surfs[i]->w, glyph_surfs[i]->h};
+            atlas_size.x += glyph_surfs[i]->w;
+            atlas_size.y = std::max(atlas_size.y, glyph_surfs[i]->h);
+        }
+    }
+
+    // everything goes in one row, for ascii at ui sizes that's well within texture limits
+
+    SDL_Surface *atlas_surf = SDL_CreateRGBSurfaceWithFormat(0, std::max(atlas_size.x, 1), std::max(atlas_size.y, 1),
+            32, SDL_PIXELFORMAT_RGBA32);
+    if (atlas_surf != nullptr) {
+        SDL_FillRect(atlas_surf, nullptr, 0);
+        for (std::size_t i = 0; i < glyphs.size(); i++) {
+            if (glyph_surfs[i] != nullptr)
+                SDL_BlitSurface(glyph_surfs[i], nullptr, atlas_surf, &glyphs[i]);
+        }
+        atlas.reset(SDL_CreateTextureFromSurface(&renderer, atlas_surf));
+        SDL_FreeSurface(atlas_surf);
+    }
+
+    for (auto *surf : glyph_surfs)
+        SDL_FreeSurface(surf);
+
+    if (atlas == nullptr) {
+        std::cerr << "failed creating glyph atlas! SDL_Error: " << SDL_GetError() << "\n";
+        throw std::runtime_error("failed creating glyph atlas");
+    }
+
+    SDL_SetTextureBlendMode(&*atlas, SDL_BLENDMODE_BLEND);
+}
+
+template <typename Fn>
+SDL_Point GlyphAtlas::lay_out(const char *text, int wrap_width, Fn &&fn) {
+    // monospaced word wrap, words longer than a line get split wherever the line ends
+
+    const int line_len = std::max(wrap_width / std::max(advance, 1), 1);
+    int col = 0, row = 0, widest = 0;
+
+    for (const char *cur = text; *cur != '\0'; cur++) {
+        if (*cur == '\n') {
+            col = 0;
+            row++;
+            continue;
+        }
+
+        if (*cur == ' ' && col > 0) {
+            int word_len = static_cast<int>(std::strcspn(cur + 1, " \n"));
+            if (col + 1 + word_len > line_len && word_len <= line_len) {
+                col = 0;
+                row++;
+                continue;
+            }
+        }
+
+        if (col >= line_len) {
+            col = 0;
+            row++;
+        }
+
+        if (*cur >= first_glyph && *cur <= last_glyph)
+            fn(static_cast<std::size_t>(*cur - first_glyph), col * advance, row * line_skip);
+
+        col++;
+        widest = std::max(widest, col);
+    }
+
+    return {widest * advance, text[0] == '\0' ? 0 : (row + 1) * line_skip};
+}
+
+SDL_Point GlyphAtlas::measure(const char *text, int wrap_width) {
+    return lay_out(text, wrap_width, [](std::size_t, int, int) {});
+}
+
+void GlyphAtlas::build(Layout &layout, const char *text, int x, int y, int wrap_width, SDL_Color color) {
+    layout.text.assign(text);
+    layout.x = x;
+    layout.y = y;
+    layout.wrap_width = wrap_width;
+    layout.color = color;
+    layout.vertices.clear();
+    layout.indices.clear();
+
+    auto size = lay_out(text, wrap_width, [&](std::size_t glyph, int glyph_x, int glyph_y) {
+        const SDL_Rect &src = glyphs[glyph];
+        float left = static_cast<float>(x + glyph_x), top = static_cast<float>(y + glyph_y);
+        float right = left + src.w, bottom = top + src.h;
+        float u0 = static_cast<float>(src.x) / atlas_size.x, u1 = static_cast<float>(src.x + src.w) / atlas_size.x;
+        float v1 = static_cast<float>(src.h) / atlas_size.y;
+
+        int base = static_cast<int>(layout.vertices.size());
+        layout.vertices.push_back({{left, top}, color, {u0, 0}});
+        layout.vertices.push_back({{right, top}, color, {u1, 0}});
+        layout.vertices.push_back({{right, bottom}, color, {u1, v1}});
+        layout.vertices.push_back({{left, bottom}, color, {u0, v1}});
+        for (int ind : {0, 1, 2, 0, 2, 3})
+            layout.indices.push_back(base + ind);
+    });
+
+    layout.bounds = {x, y, size.x, size.y};
+}
+
+SDL_Rect GlyphAtlas::draw(SDL_Renderer &renderer, const char *text, int x, int y, int wrap_width,
+        SDL_Color color, bool cache_layout)
+{
+    auto same_color = [](SDL_Color a, SDL_Color b) { return a.r == b.r && a.g == b.g && a.b == b.b && a.a == b.a; };
+
+    Layout *layout = nullptr;
+    if (cache_layout) {
+        for (auto &cached : cache) {
+            if (cached.text == text && cached.x == x && cached.y == y && cached.wrap_width == wrap_width &&
+                    same_color(cached.color, color))
+            {
+                layout = &cached;
+                break;
+            }
+        }
+
+        if (layout == nullptr) {
+            layout = &cache[next_evicted];
+            next_evicted = (next_evicted + 1) % cache.size();
+            build(*layout, text, x, y, wrap_width, color);
+        }
+    }
+    else {
+        layout = &scratch;
+        build(*layout, text, x, y, wrap_width, color);
+    }
+
+    if (!layout->indices.empty()) {
+        SDL_RenderGeometry(&renderer, &*atlas,
+                layout->vertices.data(), static_cast<int>(layout->vertices.size()),
+                layout->indices.data(), static_cast<int>(layout->indices.size()));
+    }
+
+    return layout->bounds;
+}
@@ -1,15 +1,27 @@
 #include <SDL_mouse.h>
 #include <algorithm>
+#include <array>
+#include <charconv>
+#include <chrono>
 #include <iostream>
 #include <memory>
-#include <algorithm>
+#include <random>
+#include <cmath>
 #include <string>
+#include <vector>
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
 #include "node.hpp"
+#include "grid.hpp"
 #include "graphics.hpp"
 #include "pathing.hpp"
+#include "path_cache.hpp"
 #include "maze.hpp"
+#include "map_io.hpp"
+#include "components.hpp"
+#include "flow_field.hpp"
+#include "glyph_atlas.hpp"
+#include "viewport.hpp"
 
 using namespace pathfinder2;
 using namespace pathfinder2::ui;
@@ -68,76 +80,262 @@ struct GameTextures {
     }
 };
 
-void draw_cells(
-        const NodeMatrix &nodes, 
-        const std::vector<PathPoint> &path_points, 
-        SDL_Renderer &renderer, 
-        GameTextures &textures) 
-{
-    SDL_Rect dst{0, 0, textures.node_text_size.x, textures.node_text_size.y};
-    int outer_len = nodes.size();
-    int inner_len = nodes[0].size();
-    for (int x = 0; x < outer_len; x++) {
-        for (int y = 0; y < inner_len; y++) {
-            dst.x = x * textures.node_text_size.x;
-            dst.y = y * textures.node_text_size.y;
-            SDL_RenderCopy(&renderer, &textures.node2text(nodes[x][y]), nullptr, &dst);
+std::uint32_t pack_rgba(SDL_Color color) {
+    return static_cast<std::uint32_t>(color.r) << 24 | color.g << 16 | color.b << 8 | color.a;
+}
+
+std::uint32_t blend_rgba(SDL_Color from, SDL_Color to, std::uint8_t amount) {
+    auto mix = [amount](std::uint8_t a, std::uint8_t b) {
+        return static_cast<std::uint8_t>((a * (255 - amount) + b * amount) / 255);
+    };
+    return pack_rgba({mix(from.r, to.r), mix(from.g, to.g), mix(from.b, to.b), 255});
+}
+
+// how a cell looks on screen, the search overlay only goes over walkable cells
+enum class CellLook : std::uint8_t {Walkable, Obstical, Start, End, Suboptimal, Optimal, Unknown};
+
+CellLook cell_look(const Grid &grid, const SearchResult &result, Point point) {
+    Node node = grid[point];
+    if (node != Node::Walkable)
+        return static_cast<CellLook>(node);
+    if (result.on_path(point))
+        return CellLook::Optimal;
+    if (result.visited(point))
+        return CellLook::Suboptimal;
+    return CellLook::Walkable;
+}
+
+// draws only what is under the camera into a texture the size of the grid area, so a frame costs
+// as much as the screen holds however big the map is. zoomed in cells are drawn with their
+// textures and only those that look different from last time get redrawn. zoomed out every cell
+// becomes one texel of a streaming texture, and further out every texel shades a whole block of
+// the density pyramid.
+struct GridView {
+    using text_ptr = GameTextures::text_ptr;
+
+    text_ptr view, texels;
+    std::vector<CellLook> drawn{};
+    std::vector<std::uint32_t> texel_buf{};
+    CellRect drawn_cells{};
+    std::uint64_t drawn_camera = UINT64_MAX;
+    bool stale = true;
+
+    explicit GridView(SDL_Renderer &renderer) :
+        view{create_texture(renderer, SDL_TEXTUREACCESS_TARGET, node_grid_width, node_grid_height), texture_deleter},
+        // one texel per cell needs at most a partial cell on either side of the view
+        texels{create_texture(renderer, SDL_TEXTUREACCESS_STREAMING, node_grid_width + 2, node_grid_height + 2), texture_deleter}
+    {}
+
+    static SDL_Texture *create_texture(SDL_Renderer &renderer, int access, int width, int height) {
+        SDL_Texture *text = SDL_CreateTexture(&renderer, SDL_PIXELFORMAT_RGBA8888, access, width, height);
+
+        if (text == nullptr) {
+            print_sdl_err("failed creating grid texture");
+            throw std::runtime_error("failed creating grid texture");
         }
+
+        return text;
     }
 
-    for (const auto &current_point : path_points) {
-        if (nodes[current_point.point.first][current_point.point.second] != Node::Walkable)
-            continue;
+    // the grid or the search result changed, the next draw compares every visible cell again
+    void invalidate() { stale = true; }
 
-        dst.x = current_point.point.first * textures.node_text_size.x;
-        dst.y = current_point.point.second * textures.node_text_size.y;
-        SDL_Texture *text = nullptr;
-        if (current_point.is_optimal)
-            text = &*textures.optimal;
-        else
-            text = &*textures.suboptimal;
-        SDL_RenderCopy(&renderer, text, nullptr, &dst);
+    // the target texture lost its contents
+    void reset() {
+        drawn_camera = UINT64_MAX;
+        stale = true;
     }
-}
 
-// all of this code is exception safe so dw
-void draw_msg(const char *msg, TTF_Font &font, SDL_Renderer &renderer) {
+    SDL_Rect cell_rect(Point point, const Camera &camera) const {
+        int x = camera.view_x(point.first), y = camera.view_y(point.second);
+        return {x, y, camera.view_x(point.first + 1) - x, camera.view_y(point.second + 1) - y};
+    }
+
+    void draw(const Grid &grid, const SearchResult &result, const Camera &camera, const DensityPyramid &pyramid,
+            SDL_Renderer &renderer, GameTextures &textures) {
+        if (camera.cell_px() >= min_textured_cell_px)
+            draw_textured(grid, result, camera, renderer, textures);
+        else if (stale || camera.version() != drawn_camera)
+            draw_texels(grid, result, camera, pyramid, renderer);
+
+        SDL_Rect dst{0, 0, node_grid_width, node_grid_height};
+        SDL_RenderCopy(&renderer, &*view, nullptr, &dst);
+    }
+
+    void draw_textured(const Grid &grid, const SearchResult &result, const Camera &camera, SDL_Renderer &renderer,
+            GameTextures &textures) {
+        // the texel path leaves drawn empty so coming back from it counts as a move
+        bool moved = camera.version() != drawn_camera || drawn.empty();
+        if (!moved && !stale)
+            return;
+
+        SDL_SetRenderTarget(&renderer, &*view);
+
+        // after a move nothing that was drawn is where it should be anymore
+        if (moved) {
+            SDL_SetRenderDrawColor(&renderer, 0, 0, 0, 255);
+            SDL_RenderClear(&renderer);
+            drawn_cells = camera.visible();
+            drawn.assign(static_cast<std::size_t>(std::max(drawn_cells.width(), 0)) * std::max(drawn_cells.height(), 0),
+                    CellLook::Unknown);
+        }
+
+        for (int y = drawn_cells.y0; y < drawn_cells.y1; y++) {
+            for (int x = drawn_cells.x0; x < drawn_cells.x1; x++) {
+                CellLook look = cell_look(grid, result, {x, y});
+                auto &prev = drawn[static_cast<std::size_t>(y - drawn_cells.y0) * drawn_cells.width() + x - drawn_cells.x0];
+                if (look == prev)
+                    continue;
+
+                auto rect = cell_rect({x, y}, camera);
+                SDL_RenderCopy(&renderer, &look2text(look, textures), nullptr, &rect);
+                prev = look;
+            }
+        }
+
+        SDL_SetRenderTarget(&renderer, nullptr);
+        drawn_camera = camera.version();
+        stale = false;
+    }
+
+    // a level is picked so that a block is at least a pixel wide, that keeps the texel count
+    // bounded by the size of the view
+    void draw_texels(const Grid &grid, const SearchResult &result, const Camera &camera, const DensityPyramid &pyramid,
+            SDL_Renderer &renderer) {
+        CellRect cells = camera.visible();
+        int level = 0;
+        while (level < pyramid.levels() && (1 << level) * camera.cell_px() < 1)
+            level++;
+
+        const int block = 1 << level;
+        CellRect blocks{
+            cells.x0 >> level,
+            cells.y0 >> level,
+            cells.width() > 0 ? ((cells.x1 - 1) >> level) + 1 : cells.x0 >> level,
+            cells.height() > 0 ? ((cells.y1 - 1) >> level) + 1 : cells.y0 >> level,
+        };
+
+        texel_buf.resize(static_cast<std::size_t>(blocks.width()) * blocks.height());
+        auto texel = [&](int x, int y) -> std::uint32_t & {
+            return texel_buf[static_cast<std::size_t>(y - blocks.y0) * blocks.width() + x - blocks.x0];
+        };
+
+        for (int y = blocks.y0; y < blocks.y1; y++) {
+            for (int x = blocks.x0; x < blocks.x1; x++) {
+                texel(x, y) = level == 0 ?
+                    pack_rgba(look2color(cell_look(grid, result, {x, y}))) :
+                    blend_rgba(walkable_color, obstical_color, pyramid.density(level, x, y));
+            }
+        }
+
+        // blocks are shaded by density only, the path goes on top so it stays visible
+        if (level > 0 && result.found()) {
+            auto paint = [&](Point point, SDL_Color color) {
+                int x = point.first >> level, y = point.second >> level;
+                if (x >= blocks.x0 && x < blocks.x1 && y >= blocks.y0 && y < blocks.y1)
+                    texel(x, y) = pack_rgba(color);
+            };
+
+            result.for_each_path_point([&](Point point) { paint(point, optimal_color); });
+            paint(result.path().front().from, start_color);
+        }
+
+        SDL_SetRenderTarget(&renderer, &*view);
+        SDL_SetRenderDrawColor(&renderer, 0, 0, 0, 255);
+        SDL_RenderClear(&renderer);
+
+        if (!texel_buf.empty()) {
+            SDL_Rect src{0, 0, blocks.width(), blocks.height()};
+            SDL_UpdateTexture(&*texels, &src, texel_buf.data(), blocks.width() * static_cast<int>(sizeof(std::uint32_t)));
+
+            int x = camera.view_x(blocks.x0 * block), y = camera.view_y(blocks.y0 * block);
+            SDL_Rect dst{x, y, camera.view_x(blocks.x1 * block) - x, camera.view_y(blocks.y1 * block) - y};
+            SDL_RenderCopy(&renderer, &*texels, &src, &dst);
+        }
+
+        SDL_SetRenderTarget(&renderer, nullptr);
+
+        drawn_camera = camera.version();
+        drawn.clear();
+        drawn_cells = {};
+        stale = false;
+    }
+
+    static SDL_Texture &look2text(CellLook look, GameTextures &textures) {
+        switch (look) {
+            case CellLook::Suboptimal: return *textures.suboptimal;
+            case CellLook::Optimal: return *textures.optimal;
+            default: return textures.node2text(static_cast<Node>(look));
+        }
+    }
+
+    static SDL_Color look2color(CellLook look) {
+        switch (look) {
+            case CellLook::Obstical: return obstical_color;
+            case CellLook::Start: return start_color;
+            case CellLook::End: return end_color;
+            case CellLook::Suboptimal: return suboptimal_color;
+            case CellLook::Optimal: return optimal_color;
+            default: return walkable_color;
+        }
+    }
+};
+
+// cached messages are the fixed ones that keep coming back, hover text changes with every cell
+void draw_msg(const char *msg, GlyphAtlas &text, SDL_Renderer &renderer, bool cache = true) {
     // clear the text portion of the window
 
     SDL_Rect dst{0, node_grid_height, window_width, window_height - node_grid_height};
     SDL_SetRenderDrawColor(&renderer, 0, 0, 0, 255);
     SDL_RenderFillRect(&renderer, &dst);
     
-    // create and draw the text
+    // draw the text
 
-    SDL_Surface *text_surf = TTF_RenderText_Solid_Wrapped(&font, msg, font_color, window_width);
-    SDL_Texture *text_text = SDL_CreateTextureFromSurface(&renderer, &*text_surf);
-
-    SDL_GetClipRect(text_surf, &dst);
-    dst.x = 0;
-    dst.y = node_grid_height;
+    text.draw(renderer, msg, 0, node_grid_height, window_width, font_color, cache);
+}
 
-    SDL_RenderCopy(&renderer, text_text, nullptr, &dst);
+// a short arrow from every visible cell towards the next one on its way to the goal, only once
+// the cells are big enough to tell them apart
+void draw_flow(const FlowField &flow, const Camera &camera, SDL_Renderer &renderer) {
+    if (camera.cell_px() < min_textured_cell_px)
+        return;
+
+    // the bottom row can reach into the message bar
+    SDL_Rect clip{0, 0, node_grid_width, node_grid_height};
+    SDL_RenderSetClipRect(&renderer, &clip);
+    SDL_SetRenderDrawColor(&renderer, flow_color.r, flow_color.g, flow_color.b, flow_color.a);
+
+    CellRect cells = camera.visible();
+    for (int y = cells.y0; y < cells.y1; y++) {
+        for (int x = cells.x0; x < cells.x1; x++) {
+            auto [dx, dy] = flow.direction({x, y});
+            if (dx == 0 && dy == 0)
+                continue;
+
+            int x0 = camera.view_x(x), x1 = camera.view_x(x + 1);
+            int y0 = camera.view_y(y), y1 = camera.view_y(y + 1);
+            int center_x = (x0 + x1) / 2, center_y = (y0 + y1) / 2;
+            int tip_x = center_x + dx * (x1 - x0) * 2 / 5, tip_y = center_y + dy * (y1 - y0) * 2 / 5;
+
+            SDL_RenderDrawLine(&renderer, center_x, center_y, tip_x, tip_y);
+            SDL_Rect head{tip_x - 1, tip_y - 1, 3, 3};
+            SDL_RenderFillRect(&renderer, &head);
+        }
+    }
 
-    //deinit
-    SDL_FreeSurface(text_surf);
-    SDL_DestroyTexture(text_text);
+    SDL_RenderSetClipRect(&renderer, nullptr);
 }
 
-// all of this code is exception safe so dw
-void draw_frame_ctr(TTF_Font &font, SDL_Renderer &renderer) {
+void draw_frame_ctr(GlyphAtlas &text, SDL_Renderer &renderer) {
     static unsigned long frame_cnt = 0;
     
-    // create and draw the text
+    // format into a stack buffer, the counter is redrawn every frame
 
-    auto text = std::to_string(frame_cnt++);
-    SDL_Surface *text_surf = TTF_RenderText_Solid_Wrapped(&font, text.c_str(), font_color, window_width);
-    SDL_Texture *text_text = SDL_CreateTextureFromSurface(&renderer, &*text_surf);
+    std::array<char, 32> buf{};
+    std::to_chars(buf.data(), buf.data() + buf.size() - 1, frame_cnt++);
 
-    SDL_Rect dst{};
-    SDL_GetClipRect(text_surf, &dst);
-    dst.x = window_width - dst.w;
-    dst.y = 0;
+    SDL_Point size = text.measure(buf.data(), window_width);
+    SDL_Rect dst{window_width - size.x, 0, size.x, size.y};
 
     // clear the top right portion of the window
 
@@ -146,15 +344,10 @@ void draw_frame_ctr(TTF_Font &font, SDL_Renderer &renderer) {
 
     // draw the text 
 
-    SDL_RenderCopy(&renderer, text_text, nullptr, &dst);
-
-    //deinit
-    
-    SDL_FreeSurface(text_surf);
-    SDL_DestroyTexture(text_text);
+    text.draw(renderer, buf.data(), dst.x, dst.y, window_width, font_color);
 }
 
-int pathfinder2::ui::run() {
+int pathfinder2::ui::run(const Options &options) {
     // SDL init stuff
 
     if (SDL_Init(SDL_INIT_VIDEO) < 0) {
@@ -178,7 +371,7 @@ int pathfinder2::ui::run() {
     }
 
     std::unique_ptr<SDL_Renderer, void (*)(SDL_Renderer *)> renderer{
-        SDL_CreateRenderer(&*window, -1, SDL_RENDERER_ACCELERATED),
+        SDL_CreateRenderer(&*window, -1, SDL_RENDERER_ACCELERATED | SDL_RENDERER_TARGETTEXTURE | SDL_RENDERER_PRESENTVSYNC),
         [](SDL_Renderer *renderer) { SDL_DestroyRenderer(renderer); },
     };
 
@@ -188,10 +381,23 @@ int pathfinder2::ui::run() {
     }
 
     GameTextures textures{&*renderer};
-    size_t grid_width_nodes = node_grid_width / textures.node_text_size.x;
-    size_t grid_height_nodes = node_grid_height / textures.node_text_size.y;
-    NodeMatrix node_matrix{grid_width_nodes, {grid_height_nodes, Node::Walkable}};
-    generate_maze(node_matrix);
+    Grid grid = [&] {
+        if (!options.map_path.empty())
+            return load_map(options.map_path);
+
+        int grid_width_nodes = options.grid_width > 0 ? options.grid_width : node_grid_width / textures.node_text_size.x;
+        int grid_height_nodes = options.grid_height > 0 ? options.grid_height : node_grid_height / textures.node_text_size.y;
+        Grid maze{grid_width_nodes, grid_height_nodes};
+        generate_maze(maze, MazeOptions{options.seed.value_or(std::random_device{}()), options.maze});
+        return maze;
+    }();
+
+    // which regions cells are in, so a start and end that can't reach each other skip the search
+    ComponentIndex components{grid};
+
+    // zoomed out far enough blocks of cells get shaded by how many obsticals they hold
+    DensityPyramid pyramid{grid};
+    Camera camera{grid.shape(), node_grid_width, node_grid_height, static_cast<double>(textures.node_text_size.x)};
 
     // TTF init stuff
 
@@ -210,93 +416,244 @@ int pathfinder2::ui::run() {
         [](TTF_Font *font) { TTF_CloseFont(font); },
     };
 
+    if (app_font == nullptr || frame_cnt_font == nullptr) {
+        print_sdl_err("Couldn't open font");
+        return -1;
+    }
+
+    // the glyphs get rasterized once here, drawing text afterwards only batches quads
+
+    GlyphAtlas app_text{*renderer, *app_font};
+    GlyphAtlas frame_cnt_text{*renderer, *frame_cnt_font};
+
     // Main event loop
 
     SDL_RenderClear(&*renderer);
 
-    AStar pathing_algo{};
-    std::vector<PathPoint> pathing_result{};
-    int last_mouse_x = -1, last_mouse_y = -1;
+    const auto &algorithms = pathing_algorithms();
+    std::size_t algorithm_ind = 0;
+    // asking for a path that was already found on an unchanged map, like when moving the start
+    // back, or moving it along the path, doesn't search again
+    auto make_algo = [&] { return std::make_unique<CachedPathing>(algorithms[algorithm_ind].make()); };
+    auto pathing_algo = make_algo();
+    SearchResult pathing_result{};
+    // fills pathing_result in over the next frames, declared after what it refers to so it goes first
+    SearchTask search_task{};
+    GridView grid_view{*renderer};
+
+    // f toggles arrows showing which way every cell flows towards the end. the field follows the
+    // end around and edits in between get repaired instead of starting over.
+    bool show_flow = false;
+    FlowField flow_overlay{};
+    auto sync_flow = [&] {
+        std::size_t end_ind = grid.count(Node::End) == 1 ? grid.find(Node::End) : Grid::npos;
+        if (!show_flow || end_ind == Grid::npos)
+            flow_overlay = {};
+        else if (flow_overlay.empty() || flow_overlay.goal() != grid.point(end_ind))
+            flow_overlay = FlowField{grid, grid.point(end_ind)};
+    };
+
+    // nothing gets drawn unless something changed since the last frame
+    bool dirty = true;
+    Point last_hovered{-1, -1};
+    std::uint64_t last_camera = UINT64_MAX;
+
+    // the message bar keeps showing the last message, it's drawn again with every frame
+    std::string message{};
+    bool message_cached = true;
+    auto show_msg = [&](std::string msg, bool cache = true) {
+        message = std::move(msg);
+        message_cached = cache;
+        dirty = true;
+    };
+
+    // with vsync SDL_RenderPresent waits for the display, otherwise frames wait for a deadline
+    SDL_RendererInfo renderer_info{};
+    const bool vsync = SDL_GetRendererInfo(&*renderer, &renderer_info) == 0 &&
+        (renderer_info.flags & SDL_RENDERER_PRESENTVSYNC) != 0;
+    auto next_frame = std::chrono::steady_clock::now();
 
     for (bool quit_flag = false; !quit_flag;) {
-        SDL_Event event;
+        bool recompute_required = false;
 
-        while (SDL_PollEvent(&event)) {
-            bool recompute_required = false;
+        // with nothing to draw and no search running there's nothing to do until the next event
+        SDL_Event event;
+        bool got_event = dirty || !search_task.done() ? SDL_PollEvent(&event) : SDL_WaitEvent(&event);
 
+        // every pending event is handled before anything gets recomputed or drawn, so a burst of
+        // edits costs one search
+        for (; got_event; got_event = SDL_PollEvent(&event)) {
             if (event.type == SDL_QUIT || (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_q)) {
                 std::cerr << "Quiting...\n";
                 quit_flag = true;
             }
 
-            if (event.type == SDL_MOUSEBUTTONDOWN) {
-                int x = event.button.x / textures.node_text_size.x;
-                int y = event.button.y / textures.node_text_size.y;
+            // the contents of target textures are lost when the device gets reset
+            if (event.type == SDL_RENDER_TARGETS_RESET) {
+                grid_view.reset();
+                dirty = true;
+            }
 
-                if (event.button.button == SDL_BUTTON_LEFT) {
-                    ++node_matrix[x][y];
-                    recompute_required = true;
-                }
-                if (event.button.button == SDL_BUTTON_RIGHT) {
-                    --node_matrix[x][y];
-                    recompute_required = true;
+            // the window got uncovered, resized and the like
+            if (event.type == SDL_WINDOWEVENT)
+                dirty = true;
+
+            // wheel zooms around the cursor, middle drag, the arrows and wasd pan, home shows it all
+            if (event.type == SDL_MOUSEWHEEL) {
+                int mouse_x, mouse_y;
+                SDL_GetMouseState(&mouse_x, &mouse_y);
+                camera.zoom_at(mouse_x, mouse_y, std::pow(1.25, event.wheel.y));
+            }
+            if (event.type == SDL_MOUSEMOTION && (event.motion.state & SDL_BUTTON_MMASK))
+                camera.pan(-event.motion.xrel, -event.motion.yrel);
+            if (event.type == SDL_KEYDOWN) {
+                constexpr int step = node_grid_width / 8;
+                switch (event.key.keysym.sym) {
+                    case SDLK_LEFT: case SDLK_a: camera.pan(-step, 0); break;
+                    case SDLK_RIGHT: case SDLK_d: camera.pan(step, 0); break;
+                    case SDLK_UP: case SDLK_w: camera.pan(0, -step); break;
+                    case SDLK_DOWN: case SDLK_s: camera.pan(0, step); break;
+                    case SDLK_HOME: camera.fit(); break;
                 }
             }
 
-            if (recompute_required) {
-                // confirm that there's only one start and end node
-                int start_cnt = 0, end_cnt = 0;
-                for (const auto &col : node_matrix) {
-                    for (auto node : col) {
-                        if (node == Node::Start)
-                            start_cnt++;
-                        else if (node == Node::End)
-                            end_cnt++;
+            // j dumps what the last search cost for comparing runs outside of the app
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_j) {
+                if constexpr (search_stats_enabled)
+                    std::cout << pathing_result.stats().to_json() << std::endl;
+                else
+                    std::cerr << "Search stats are compiled out, build with PATHFINDER2_SEARCH_STATS\n";
+            }
+
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_f) {
+                show_flow = !show_flow;
+                sync_flow();
+                dirty = true;
+            }
+
+            // tab cycles through the algorithms so they can be compared on the same grid
+            if (event.type == SDL_KEYDOWN && event.key.keysym.sym == SDLK_TAB) {
+                algorithm_ind = (algorithm_ind + 1) % algorithms.size();
+                search_task.cancel();
+                pathing_algo = make_algo();
+                show_msg(std::string{"Pathing with "} + algorithms[algorithm_ind].name);
+                recompute_required = true;
+            }
+
+            if (event.type == SDL_MOUSEBUTTONDOWN && event.button.y < node_grid_height) {
+                Point clicked = camera.cell_at(event.button.x, event.button.y);
+
+                // the view can show space around the map
+                if (grid.in_bounds(clicked)) {
+                    Node node = grid[clicked];
+                    bool edited = false;
+
+                    // a search still running is about to be out of date
+                    if (event.button.button == SDL_BUTTON_LEFT || event.button.button == SDL_BUTTON_RIGHT)
+                        search_task.cancel();
+
+                    if (event.button.button == SDL_BUTTON_LEFT) {
+                        grid.set(clicked, ++node);
+                        edited = true;
+                    }
+                    if (event.button.button == SDL_BUTTON_RIGHT) {
+                        grid.set(clicked, --node);
+                        edited = true;
                     }
-                }
 
-                if (start_cnt == 1 && end_cnt == 1) {
-                    pathing_result = pathing_algo.find_path(node_matrix);
-                    if (pathing_result.size() == 0)
-                        draw_msg("There is no way to the endpoint from the startpoint", *app_font, *renderer);
-                }
-                else {
-                    pathing_result = {};
-                    if (start_cnt != 1)
-                        draw_msg("There has to be exactly one start (blue) node", *app_font, *renderer);
-                    else if (end_cnt != 1)
-                        draw_msg("There has to be exactly one end (red) node", *app_font, *renderer);
+                    if (edited) {
+                        pathing_algo->cell_changed(grid, clicked);
+                        pyramid.update(grid, clicked);
+                        components.cell_changed(grid, clicked);
+                        if (!flow_overlay.empty())
+                            flow_overlay.cell_changed(grid, clicked);
+                        recompute_required = true;
+                    }
                 }
             }
+        }
+
+        if (recompute_required) {
+            sync_flow();
+
+            // confirm that there's only one start and end node
+            std::size_t start_cnt = grid.count(Node::Start);
+            std::size_t end_cnt = grid.count(Node::End);
+
+            bool reachable = start_cnt == 1 && end_cnt == 1 &&
+                components.connected(grid.point(grid.find(Node::Start)), grid.point(grid.find(Node::End)));
+
+            if (start_cnt == 1 && end_cnt == 1 && !reachable) {
+                pathing_result.reset(grid.shape());
+                show_msg("There is no way to the endpoint from the startpoint");
+            }
+            else if (start_cnt == 1 && end_cnt == 1) {
+                // written in place so the per cell buffers of the last result get reused, the
+                // search itself runs below a slice per frame
+                search_task = pathing_algo->find_path_sliced(grid, pathing_result);
+            }
+            else {
+                pathing_result.reset(grid.shape());
+                if (start_cnt != 1)
+                    show_msg("There has to be exactly one start (blue) node");
+                else if (end_cnt != 1)
+                    show_msg("There has to be exactly one end (red) node");
+            }
+
+            grid_view.invalidate();
+            dirty = true;
+        }
 
-            draw_cells(node_matrix, pathing_result, *renderer, textures);
+        // however big the search, a frame only waits search_budget for it and then shows the
+        // cells expanded so far
+        if (!search_task.done()) {
+            if (search_task.run_for(search_budget)) {
+                if (!pathing_result.found())
+                    show_msg("There is no way to the endpoint from the startpoint");
+                else if (pathing_algo->last_hit())
+                    show_msg(pathing_algo->stats().summary(), false);
+                else if constexpr (search_stats_enabled)
+                    show_msg(pathing_result.stats().summary(), false);
+            }
+            grid_view.invalidate();
+            dirty = true;
         }
 
+        // text for the cell underneeth the cursor, only looked up again once the cursor is over
+        // another cell or the camera moved
         int mouse_x, mouse_y;
         SDL_GetMouseState(&mouse_x, &mouse_y);
+        Point hovered = mouse_y < node_grid_height ? camera.cell_at(mouse_x, mouse_y) : Point{-1, -1};
 
-        // draws text for the cell underneeth the cursor when the cursor position changes
-        if (last_mouse_x != mouse_x || last_mouse_y != mouse_y) {
-            for (const auto &cur_result : pathing_result) {
-                if (mouse_x / textures.node_text_size.x == cur_result.point.first &&
-                    mouse_y / textures.node_text_size.y == cur_result.point.second &&
-                    cur_result.text != std::nullopt) 
-                {
-                    draw_msg(cur_result.text->c_str(), *app_font, *renderer);
-                    break;
-                }
-            }
+        if (hovered != last_hovered || last_camera != camera.version()) {
+            if (auto msg = pathing_result.describe(hovered))
+                show_msg(std::move(*msg), false);
+            if (last_camera != camera.version())
+                dirty = true;
 
-            last_mouse_x = mouse_x;
-            last_mouse_y = mouse_y;
+            last_hovered = hovered;
+            last_camera = camera.version();
         }
 
-        draw_frame_ctr(*frame_cnt_font, *renderer);
-        
-        SDL_RenderPresent(&*renderer);
+        if (!dirty)
+            continue;
 
-        // ~60fps
-        SDL_Delay(17);
+        grid_view.draw(grid, pathing_result, camera, pyramid, *renderer, textures);
+        if (!flow_overlay.empty())
+            draw_flow(flow_overlay, camera, *renderer);
+        draw_msg(message.c_str(), app_text, *renderer, message_cached);
+        draw_frame_ctr(frame_cnt_text, *renderer);
+
+        SDL_RenderPresent(&*renderer);
+        dirty = false;
+
+        // without vsync the rest of the frame is slept off, a late frame doesn't make the next
+        // one shorter
+        if (!vsync) {
+            auto now = std::chrono::steady_clock::now();
+            next_frame = std::max(next_frame + frame_time, now);
+            SDL_Delay(static_cast<Uint32>(std::chrono::duration_cast<std::chrono::milliseconds>(next_frame - now).count()));
+        }
     }
 
     // Teardown of SDL and SDL_ttf is done in main()
@@ -0,0 +1,103 @@
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include "grid.hpp"
+
+using namespace pathfinder2;
+
+Grid::Grid(int width, int height, Node fill_node) : GridShape{width, height} {
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("Grid dimensions have to be positive");
+
+    cells.assign(padded_size(), Node::Obstical);
+    fill(fill_node);
+}
+
+std::uint64_t Grid::first_revision() {
+    // 2^32 edits apart, grids get made on the batch threads too
+    static std::atomic<std::uint64_t> grid_cnt{0};
+    return ++grid_cnt << 32;
+}
+
+Grid &Grid::operator=(const Grid &other) {
+    GridShape::operator=(other);
+    cells = other.cells;
+    cell_revision = first_revision();
+    last_edited = npos;
+    return *this;
+}
+
+void Grid::fill(Node node) {
+    cell_revision++;
+    last_edited = npos;
+    for (int y = 0; y < height(); y++) {
+        auto row = cells.begin() + index({0, y});
+        std::fill(row, row + width(), node);
+    }
+}
+
+void Grid::assign_row(int y, const std::uint64_t *obsticals) {
+    static_assert(sizeof(Node) == 1 && static_cast<int>(Node::Walkable) == 0 && static_cast<int>(Node::Obstical) == 1);
+
+    cell_revision++;
+    last_edited = npos;
+    Node *row = cells.data() + index({0, y});
+    int x = 0;
+
+    // 8 cells at a time, entry b has bit i of b in byte i
+    if constexpr (std::endian::native == std::endian::little) {
+        static constexpr auto spread = [] {
+            std::array<std::uint64_t, 256> table{};
+            for (std::size_t b = 0; b < table.size(); b++) {
+                for (int i = 0; i < 8; i++)
+                    table[b] |= static_cast<std::uint64_t>(b >> i & 1) << (8 * i);
+            }
+            return table;
+        }();
+
+        for (; x + 8 <= width(); x += 8) {
+            std::uint64_t cells8 = spread[obsticals[x / 64] >> (x % 64) & 0xff];
+            std::memcpy(row + x, &cells8, sizeof(cells8));
+        }
+    }
+
+    for (; x < width(); x++)
+        row[x] = static_cast<Node>(obsticals[x / 64] >> (x % 64) & 1);
+}
+
+std::size_t Grid::find(Node node) const {
+    // the border only ever holds obsticals
+    if (node == Node::Obstical) {
+        for (int y = 0; y < height(); y++) {
+            auto row = cells.begin() + index({0, y});
+            auto found = std::find(row, row + width(), node);
+            if (found != row + width())
+                return found - cells.begin();
+        }
+        return npos;
+    }
+
+    auto found = std::find(cells.begin(), cells.end(), node);
+    return found == cells.end() ? npos : found - cells.begin();
+}
+
+std::size_t Grid::count(Node node) const {
+    std::size_t cnt = 0;
+    for (int y = 0; y < height(); y++) {
+        auto row = cells.begin() + index({0, y});
+        cnt += std::count(row, row + width(), node);
+    }
+    return cnt;
+}
+
+BitGrid Grid::obstacle_bitmap() const {
+    BitGrid bitmap{cells.size()};
+    for (std::size_t i = 0; i < cells.size(); i++) {
+        if (cells[i] == Node::Obstical)
+            bitmap.set(i);
+    }
+    return bitmap;
+}
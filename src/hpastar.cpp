@@ -0,0 +1,435 @@
+#include <stdexcept>
+#include <vector>
+#include <queue>
+#include <tuple>
+#include <unordered_map>
+#include <algorithm>
+#include <climits>
+#include "pathing.hpp"
+#include "node.hpp"
+#include "grid.hpp"
+#include "search_kernel.hpp"
+
+using namespace pathfinder2;
+
+// the abstract graph is built from runs of cells along a cluster border where both sides are
+// walkable, each run gets a crossing in the middle or one at each end when it's long. crossings
+// that would only be possible diagonally aren't part of the graph, if that leaves the abstract
+// search without a path the query falls back to a plain A* over the whole grid.
+
+namespace {
+    constexpr int inf = INT_MAX / 2;
+
+    // runs at least this long get a crossing at each end instead of one in the middle
+    constexpr int long_run = 6;
+
+    constexpr auto &steps = EightConnected::steps;
+
+    // never more than the real cost, so the abstract search stays admissible
+    int heuristic(Point point, Point end_point) {
+        return OctileHeuristic::distance(point, end_point);
+    }
+
+    // the start and the end get their own abstract nodes, they can't clash with padded indices
+    constexpr std::uint32_t start_node = UINT32_MAX;
+    constexpr std::uint32_t end_node = UINT32_MAX - 1;
+}
+
+HPAStar::Bounds HPAStar::bounds(std::size_t cluster) const {
+    int x0 = static_cast<int>(cluster % clusters_x) * cluster_size;
+    int y0 = static_cast<int>(cluster / clusters_x) * cluster_size;
+    return {x0, y0, std::min(x0 + cluster_size, built_shape.width()), std::min(y0 + cluster_size, built_shape.height())};
+}
+
+std::size_t HPAStar::cluster_of(Point p) const {
+    return static_cast<std::size_t>(p.second / cluster_size) * clusters_x + p.first / cluster_size;
+}
+
+std::size_t HPAStar::local_ind(const Bounds &bounds, Point p) const {
+    return static_cast<std::size_t>(p.second - bounds.y0) * cluster_size + (p.first - bounds.x0);
+}
+
+void HPAStar::build(const Grid &grid) {
+    built_shape = grid.shape();
+    built_revision = grid.revision();
+    clusters_x = (grid.width() + cluster_size - 1) / cluster_size;
+    clusters_y = (grid.height() + cluster_size - 1) / cluster_size;
+    clusters.assign(static_cast<std::size_t>(clusters_x) * clusters_y, Cluster{});
+
+    local_costs.assign(cluster_size * cluster_size, inf);
+    local_parents.assign(cluster_size * cluster_size, -1);
+    local_open.reset(cluster_size * cluster_size);
+
+    // every crossing has to be known before any cluster can collect its entrances
+    for (std::size_t cluster = 0; cluster < clusters.size(); cluster++)
+        find_transitions(grid, cluster);
+    for (std::size_t cluster = 0; cluster < clusters.size(); cluster++)
+        connect_entrances(grid, cluster);
+}
+
+void HPAStar::find_transitions(const Grid &grid, std::size_t cluster) {
+    const Bounds b = bounds(cluster);
+    const int cx = static_cast<int>(cluster % clusters_x), cy = static_cast<int>(cluster / clusters_x);
+
+    // walks along a border and adds crossings for every run of open pairs
+    auto scan = [&](std::vector<Transition> &out, int len, auto inside_at, Point step) {
+        out.clear();
+        auto add = [&](int i) {
+            Point inside = inside_at(i);
+            out.push_back({
+                static_cast<std::uint32_t>(grid.index(inside)),
+                static_cast<std::uint32_t>(grid.index(inside + step)),
+            });
+        };
+
+        for (int i = 0; i < len;) {
+            auto open = [&](int j) {
+                Point inside = inside_at(j);
+                return grid.walkable(grid.index(inside)) && grid.walkable(grid.index(inside + step));
+            };
+
+            if (!open(i)) {
+                i++;
+                continue;
+            }
+
+            int run_start = i;
+            while (i < len && open(i))
+                i++;
+
+            if (i - run_start >= long_run) {
+                add(run_start);
+                add(i - 1);
+            }
+            else {
+                add(run_start + (i - run_start) / 2);
+            }
+        }
+    };
+
+    if (cx + 1 < clusters_x)
+        scan(clusters[cluster].east, b.y1 - b.y0, [&](int i) { return Point{b.x1 - 1, b.y0 + i}; }, Point{1, 0});
+    if (cy + 1 < clusters_y)
+        scan(clusters[cluster].south, b.x1 - b.x0, [&](int i) { return Point{b.x0 + i, b.y1 - 1}; }, Point{0, 1});
+}
+
+void HPAStar::connect_entrances(const Grid &grid, std::size_t cluster) {
+    Cluster &c = clusters[cluster];
+    const int cx = static_cast<int>(cluster % clusters_x), cy = static_cast<int>(cluster / clusters_x);
+
+    c.entrances.clear();
+    for (auto t : c.east)
+        c.entrances.push_back(t.inside);
+    for (auto t : c.south)
+        c.entrances.push_back(t.inside);
+    if (cx > 0) {
+        for (auto t : clusters[cluster - 1].east)
+            c.entrances.push_back(t.outside);
+    }
+    if (cy > 0) {
+        for (auto t : clusters[cluster - clusters_x].south)
+            c.entrances.push_back(t.outside);
+    }
+
+    // a corner cell can be on two borders
+    std::sort(c.entrances.begin(), c.entrances.end());
+    c.entrances.erase(std::unique(c.entrances.begin(), c.entrances.end()), c.entrances.end());
+
+    const std::size_t k = c.entrances.size();
+    const Bounds b = bounds(cluster);
+    c.costs.assign(k * k, inf);
+    for (std::size_t i = 0; i < k; i++) {
+        search_cluster(grid, cluster, c.entrances[i]);
+        for (std::size_t j = 0; j < k; j++)
+            c.costs[i * k + j] = local_costs[local_ind(b, grid.point(c.entrances[j]))];
+    }
+}
+
+void HPAStar::search_cluster(const Grid &grid, std::size_t cluster, std::size_t from) {
+    // dijkstra from one cell to the whole cluster, it's small enough that aiming isn't worth it
+
+    const Bounds b = bounds(cluster);
+    std::fill(local_costs.begin(), local_costs.end(), inf);
+    std::fill(local_parents.begin(), local_parents.end(), -1);
+
+    Point from_point = grid.point(from);
+    auto from_local = static_cast<std::uint32_t>(local_ind(b, from_point));
+    local_costs[from_local] = 0;
+    local_open.push_or_decrease(from_local, 0);
+    PF2_PROBE(search_stats, pushed, 1);
+    PF2_PROBE(search_stats, heap_ops, 1);
+
+    while (!local_open.empty()) {
+        auto [current, cost] = local_open.pop();
+        PF2_PROBE(search_stats, heap_ops, 1);
+        PF2_PROBE(search_stats, expanded, 1);
+        Point point{b.x0 + static_cast<int>(current % cluster_size), b.y0 + static_cast<int>(current / cluster_size)};
+
+        for (const auto &step : steps) {
+            Point next = point + step.offset();
+            if (next.first < b.x0 || next.first >= b.x1 || next.second < b.y0 || next.second >= b.y1)
+                continue;
+            if (!grid.walkable(grid.index(next)))
+                continue;
+
+            auto next_local = static_cast<std::uint32_t>(local_ind(b, next));
+            int next_cost = cost + step.cost;
+            if (next_cost >= local_costs[next_local])
+                continue;
+
+            if (local_costs[next_local] == inf)
+                PF2_PROBE(search_stats, pushed, 1);
+            else
+                PF2_PROBE(search_stats, reparents, 1);
+            PF2_PROBE(search_stats, heap_ops, 1);
+
+            local_costs[next_local] = next_cost;
+            local_parents[next_local] = static_cast<std::int32_t>(current);
+            local_open.push_or_decrease(next_local, next_cost);
+        }
+    }
+}
+
+bool HPAStar::append_cluster_path(const Grid &grid, std::size_t from, std::size_t to, std::vector<std::uint32_t> &cells) {
+    const std::size_t cluster = cluster_of(grid.point(from));
+    const Bounds b = bounds(cluster);
+    search_cluster(grid, cluster, from);
+
+    // walk back from to and flip the cells into place. to can only be cut off from from if the
+    // graph doesn't match the grid anymore
+    std::size_t first = cells.size();
+    auto from_local = static_cast<std::int32_t>(local_ind(b, grid.point(from)));
+    for (auto local = static_cast<std::int32_t>(local_ind(b, grid.point(to))); local != from_local; local = local_parents[local]) {
+        if (local == -1)
+            return false;
+        Point point{b.x0 + local % cluster_size, b.y0 + local / cluster_size};
+        cells.push_back(static_cast<std::uint32_t>(grid.index(point)));
+    }
+    std::reverse(cells.begin() + first, cells.end());
+    return true;
+}
+
+void HPAStar::cell_changed(const Grid &grid, Point p) {
+    // nothing built yet, or it'll get thrown away on the next search anyway
+    if (grid.shape() != built_shape || !grid.in_bounds(p))
+        return;
+
+    // the start or end moving doesn't change the revision or any crossing. with an edit in
+    // between that wasn't reported the graph is left behind and the next search builds it again.
+    if (grid.revision() == built_revision || !grid.follows(built_revision, p))
+        return;
+    built_revision = grid.revision();
+
+    const std::size_t cluster = cluster_of(p);
+    const int cx = static_cast<int>(cluster % clusters_x), cy = static_cast<int>(cluster / clusters_x);
+
+    // the cell can only be on the borders the cluster shares with its four neighbours, the west
+    // and north ones are stored by the neighbour
+    find_transitions(grid, cluster);
+    if (cx > 0)
+        find_transitions(grid, cluster - 1);
+    if (cy > 0)
+        find_transitions(grid, cluster - clusters_x);
+
+    connect_entrances(grid, cluster);
+    if (cx > 0)
+        connect_entrances(grid, cluster - 1);
+    if (cy > 0)
+        connect_entrances(grid, cluster - clusters_x);
+    if (cx + 1 < clusters_x)
+        connect_entrances(grid, cluster + 1);
+    if (cy + 1 < clusters_y)
+        connect_entrances(grid, cluster + clusters_x);
+}
+
+SearchResult HPAStar::find_path(const Grid &grid) {
+    PF2_PROBE_TIMER(probe_start);
+
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
+
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    // another grid or edits that weren't reported through cell_changed()
+    if (grid.shape() != built_shape || grid.revision() != built_revision)
+        build(grid);
+
+    // only the work of this query counts, not the precompute or the repairs
+    search_stats = {};
+
+    const Point start_point = grid.point(start_ind);
+    const Point end_point = grid.point(end_ind);
+    const std::size_t start_cluster = cluster_of(start_point);
+    const std::size_t end_cluster = cluster_of(end_point);
+
+    // the start and the end get hooked up to the entrances of their clusters for this search only
+
+    search_cluster(grid, start_cluster, start_ind);
+    std::vector<int> start_costs{};
+    for (auto entrance : clusters[start_cluster].entrances)
+        start_costs.push_back(local_costs[local_ind(bounds(start_cluster), grid.point(entrance))]);
+    int direct_cost = start_cluster == end_cluster ? local_costs[local_ind(bounds(end_cluster), end_point)] : inf;
+
+    search_cluster(grid, end_cluster, end_ind);
+    std::vector<int> end_costs{};
+    for (auto entrance : clusters[end_cluster].entrances)
+        end_costs.push_back(local_costs[local_ind(bounds(end_cluster), grid.point(entrance))]);
+
+    // A* over the abstract graph, nodes are the padded indices of the entrances
+
+    struct AbstractState {
+        int g_cost = inf;
+        std::uint32_t parent = start_node;
+        bool closed = false;
+    };
+
+    std::unordered_map<std::uint32_t, AbstractState> states{};
+    using Entry = std::tuple<int, int, std::uint32_t>;
+    std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> open_list{};
+    SearchResult result{grid.shape()};
+
+    auto point_of = [&](std::uint32_t node) {
+        return node == start_node ? start_point : node == end_node ? end_point : grid.point(node);
+    };
+
+    auto relax = [&](std::uint32_t node, std::uint32_t parent, int g_cost) {
+        auto &state = states[node];
+        if (state.closed || g_cost >= state.g_cost)
+            return;
+
+        if (state.g_cost == inf)
+            PF2_PROBE(search_stats, pushed, 1);
+        else
+            PF2_PROBE(search_stats, reparents, 1);
+        PF2_PROBE(search_stats, heap_ops, 1);
+
+        state.g_cost = g_cost;
+        state.parent = parent;
+        int h_cost = heuristic(point_of(node), end_point);
+        open_list.push({g_cost + h_cost, h_cost, node});
+    };
+
+    states[start_node].g_cost = 0;
+    open_list.push({heuristic(start_point, end_point), heuristic(start_point, end_point), start_node});
+    PF2_PROBE(search_stats, pushed, 1);
+    PF2_PROBE(search_stats, heap_ops, 1);
+
+    while (!open_list.empty()) {
+        auto [f_cost, h_cost, node] = open_list.top();
+        open_list.pop();
+        PF2_PROBE(search_stats, heap_ops, 1);
+
+        auto &state = states[node];
+        if (state.closed)
+            continue;
+        state.closed = true;
+        PF2_PROBE(search_stats, expanded, 1);
+
+        int g_cost = state.g_cost;
+        result.mark_visited(node == start_node ? start_ind : node == end_node ? end_ind : node, g_cost, h_cost);
+        if (node == end_node)
+            break;
+
+        if (node == start_node) {
+            const auto &entrances = clusters[start_cluster].entrances;
+            for (std::size_t i = 0; i < entrances.size(); i++) {
+                if (start_costs[i] < inf)
+                    relax(entrances[i], node, start_costs[i]);
+            }
+            if (direct_cost < inf)
+                relax(end_node, node, direct_cost);
+            continue;
+        }
+
+        const std::size_t cluster = cluster_of(grid.point(node));
+        const Cluster &c = clusters[cluster];
+        const std::size_t k = c.entrances.size();
+        const auto i = static_cast<std::size_t>(std::lower_bound(c.entrances.begin(), c.entrances.end(), node) - c.entrances.begin());
+
+        // across the cluster
+        for (std::size_t j = 0; j < k; j++) {
+            if (j != i && c.costs[i * k + j] < inf)
+                relax(c.entrances[j], node, g_cost + c.costs[i * k + j]);
+        }
+        if (cluster == end_cluster && end_costs[i] < inf)
+            relax(end_node, node, g_cost + end_costs[i]);
+
+        // and over its borders
+        const int cx = static_cast<int>(cluster % clusters_x), cy = static_cast<int>(cluster / clusters_x);
+        for (auto t : c.east) {
+            if (t.inside == node)
+                relax(t.outside, node, g_cost + 10);
+        }
+        for (auto t : c.south) {
+            if (t.inside == node)
+                relax(t.outside, node, g_cost + 10);
+        }
+        if (cx > 0) {
+            for (auto t : clusters[cluster - 1].east) {
+                if (t.outside == node)
+                    relax(t.inside, node, g_cost + 10);
+            }
+        }
+        if (cy > 0) {
+            for (auto t : clusters[cluster - clusters_x].south) {
+                if (t.outside == node)
+                    relax(t.inside, node, g_cost + 10);
+            }
+        }
+    }
+
+    auto fall_back = [&] {
+        AStar fallback{};
+        auto fallback_result = fallback.find_path(grid);
+        // the time covers the abstract search too, not just the fallback
+        PF2_PROBE_SET(fallback_result.stats(), elapsed_ms, 0);
+        PF2_PROBE_ELAPSED(fallback_result.stats(), probe_start);
+        return fallback_result;
+    };
+
+    // either there is no path or it needs a crossing the abstract graph doesn't have
+    if (!states[end_node].closed)
+        return fall_back();
+
+    // refine every hop of the abstract path into cells
+
+    std::vector<std::uint32_t> hops{};
+    for (std::uint32_t node = end_node; node != start_node; node = states[node].parent)
+        hops.push_back(node == end_node ? static_cast<std::uint32_t>(end_ind) : node);
+    hops.push_back(static_cast<std::uint32_t>(start_ind));
+    std::reverse(hops.begin(), hops.end());
+
+    std::vector<std::uint32_t> cells{hops.front()};
+    for (std::size_t i = 1; i < hops.size(); i++) {
+        std::uint32_t from = cells.back(), to = hops[i];
+        if (from == to)
+            continue;
+
+        // hops between clusters are single steps over the border
+        if (cluster_of(grid.point(from)) != cluster_of(grid.point(to)))
+            cells.push_back(to);
+        else if (!append_cluster_path(grid, from, to, cells))
+            return fall_back();
+    }
+
+    int g_cost = 0;
+    for (std::size_t i = 0; i < cells.size(); i++) {
+        Point point = grid.point(cells[i]);
+        if (i > 0) {
+            Point prev = grid.point(cells[i - 1]);
+            g_cost += prev.first != point.first && prev.second != point.second ? 14 : 10;
+        }
+        result.set_costs(cells[i], g_cost, heuristic(point, end_point));
+    }
+    result.set_path(cells);
+
+    // the abstract graph is kept between searches, only the per query state counts as scratch
+    PF2_PROBE_SET(search_stats, peak_scratch_bytes,
+            local_costs.capacity() * sizeof(local_costs[0]) + local_parents.capacity() * sizeof(local_parents[0]) +
+            local_open.memory_bytes() + states.size() * (sizeof(std::uint32_t) + sizeof(AbstractState)) +
+            hops.capacity() * sizeof(hops[0]) + cells.capacity() * sizeof(cells[0]));
+    result.stats() = search_stats;
+    PF2_PROBE_ELAPSED(result.stats(), probe_start);
+    return result;
+}
@@ -0,0 +1,329 @@
+#include <stdexcept>
+#include <vector>
+#include <array>
+#include <utility>
+#include <climits>
+#include <cstdlib>
+#include <algorithm>
+#include "pathing.hpp"
+#include "node.hpp"
+#include "grid.hpp"
+#include "open_list.hpp"
+
+using namespace pathfinder2;
+
+// jump point search on the same movement rules as AStar: 8 connected, uniform cost and
+// diagonal moves are always allowed as long as the target cell is walkable (corners can be
+// cut). instead of pushing every neighbour it only pushes the jump points found by scanning
+// along straight and diagonal lines, which keeps the open list tiny in open areas.
+
+namespace {
+    // straight directions first, jps+ tables are indexed in this order too
+    constexpr std::array<Point, 8> directions = {{
+        {1, 0}, {-1, 0}, {0, 1}, {0, -1},
+        {1, 1}, {-1, 1}, {1, -1}, {-1, -1},
+    }};
+
+    int direction_ind(Point dir) {
+        // index into directions by (dy + 1) * 3 + (dx + 1)
+        constexpr std::array<int, 9> lookup = {7, 3, 6, 1, -1, 0, 5, 2, 4};
+        return lookup[(dir.second + 1) * 3 + dir.first + 1];
+    }
+
+    // the octile distance is exactly the cost of walking between two cells on a common line or
+    // diagonal, which is all a jump does, and the same bound AStar uses towards the end
+    int heuristic(Point point, Point end_point) {
+        return OctileHeuristic::distance(point, end_point);
+    }
+
+    class Neighbourhood {
+    public:
+        explicit Neighbourhood(const Grid &grid) : grid{grid} {}
+
+        bool walkable(std::size_t ind, Point dir) const { return grid.walkable(ind + grid.offset(dir)); }
+
+        // whether a cell entered moving in dir has a neighbour that can only be reached
+        // optimally through it
+        bool has_forced(std::size_t ind, Point dir) const {
+            auto [dx, dy] = dir;
+            if (dx != 0 && dy != 0) {
+                return (walkable(ind, {-dx, dy}) && !walkable(ind, {-dx, 0})) ||
+                    (walkable(ind, {dx, -dy}) && !walkable(ind, {0, -dy}));
+            }
+            if (dx != 0) {
+                return (walkable(ind, {dx, 1}) && !walkable(ind, {0, 1})) ||
+                    (walkable(ind, {dx, -1}) && !walkable(ind, {0, -1}));
+            }
+            return (walkable(ind, {1, dy}) && !walkable(ind, {1, 0})) ||
+                (walkable(ind, {-1, dy}) && !walkable(ind, {-1, 0}));
+        }
+
+        // directions worth searching from a jump point reached moving in dir, {0, 0} means the
+        // node has no parent (the start) so every direction is searched
+        int successor_dirs(std::size_t ind, Point dir, std::array<Point, 8> &out) const {
+            auto [dx, dy] = dir;
+            int cnt = 0;
+            auto add = [&](Point d) {
+                if (walkable(ind, d))
+                    out[cnt++] = d;
+            };
+
+            if (dx == 0 && dy == 0) {
+                for (auto d : directions)
+                    add(d);
+            }
+            else if (dx != 0 && dy != 0) {
+                add({0, dy});
+                add({dx, 0});
+                add({dx, dy});
+                if (!walkable(ind, {-dx, 0}))
+                    add({-dx, dy});
+                if (!walkable(ind, {0, -dy}))
+                    add({dx, -dy});
+            }
+            else if (dx == 0) {
+                add({0, dy});
+                if (!walkable(ind, {1, 0}))
+                    add({1, dy});
+                if (!walkable(ind, {-1, 0}))
+                    add({-1, dy});
+            }
+            else {
+                add({dx, 0});
+                if (!walkable(ind, {0, 1}))
+                    add({dx, 1});
+                if (!walkable(ind, {0, -1}))
+                    add({dx, -1});
+            }
+            return cnt;
+        }
+
+    private:
+        const Grid &grid;
+    };
+
+    // A* over jump points, jump(ind, dir, end_ind) returns the next jump point from ind in
+    // direction dir or Grid::npos
+    template <typename JumpFn>
+    SearchResult search_jump_points(const Grid &grid, JumpFn &&jump) {
+        PF2_PROBE_TIMER(probe_start);
+        std::size_t start_ind = grid.find(Node::Start);
+        std::size_t end_ind = grid.find(Node::End);
+
+        if (start_ind == Grid::npos || end_ind == Grid::npos)
+            throw std::invalid_argument("No start and/or end point");
+
+        const Point end_point = grid.point(end_ind);
+        const std::size_t cell_cnt = grid.padded_size();
+        Neighbourhood neighbourhood{grid};
+
+        std::vector<int> g_costs(cell_cnt, INT_MAX);
+        std::vector<std::int32_t> parents(cell_cnt, -1);
+        BitGrid closed{cell_cnt};
+        SearchResult result{grid.shape()};
+        IndexedBinaryHeap<std::pair<int, int>> open_list{cell_cnt};
+        PF2_PROBE_SET(result.stats(), peak_scratch_bytes,
+                g_costs.capacity() * sizeof(g_costs[0]) + parents.capacity() * sizeof(parents[0]) +
+                closed.word_count() * sizeof(std::uint64_t) + open_list.memory_bytes());
+
+        g_costs[start_ind] = 0;
+        int start_h_cost = heuristic(grid.point(start_ind), end_point);
+        open_list.push_or_decrease(static_cast<std::uint32_t>(start_ind), {start_h_cost, start_h_cost});
+        PF2_PROBE(result.stats(), pushed, 1);
+        PF2_PROBE(result.stats(), heap_ops, 1);
+
+        std::array<Point, 8> dirs{};
+
+        while (!open_list.empty()) {
+            auto [current_ind, key] = open_list.pop();
+            closed.set(current_ind);
+            result.mark_visited(current_ind, g_costs[current_ind], key.second);
+            PF2_PROBE(result.stats(), heap_ops, 1);
+            PF2_PROBE(result.stats(), expanded, 1);
+
+            if (current_ind == end_ind)
+                break;
+
+            Point current_point = grid.point(current_ind);
+            Point parent_dir{0, 0};
+            if (parents[current_ind] != -1) {
+                Point parent_point = grid.point(parents[current_ind]);
+                parent_dir = {sign(current_point.first - parent_point.first), sign(current_point.second - parent_point.second)};
+            }
+
+            int dir_cnt = neighbourhood.successor_dirs(current_ind, parent_dir, dirs);
+            for (int i = 0; i < dir_cnt; i++) {
+                std::size_t jump_ind = jump(current_ind, dirs[i], end_ind);
+                if (jump_ind == Grid::npos || closed.test(jump_ind))
+                    continue;
+
+                Point jump_point = grid.point(jump_ind);
+                int g_cost = g_costs[current_ind] + OctileHeuristic::distance(current_point, jump_point);
+                if (g_cost >= g_costs[jump_ind])
+                    continue;
+
+                if (g_costs[jump_ind] == INT_MAX)
+                    PF2_PROBE(result.stats(), pushed, 1);
+                else
+                    PF2_PROBE(result.stats(), reparents, 1);
+                PF2_PROBE(result.stats(), heap_ops, 1);
+
+                g_costs[jump_ind] = g_cost;
+                parents[jump_ind] = static_cast<std::int32_t>(current_ind);
+                int h_cost = heuristic(jump_point, end_point);
+                open_list.push_or_decrease(static_cast<std::uint32_t>(jump_ind), {g_cost + h_cost, h_cost});
+            }
+        }
+
+        if (!closed.test(end_ind)) {
+            PF2_PROBE_ELAPSED(result.stats(), probe_start);
+            return result; // no possible way to endpoint
+        }
+
+        // the cells between the jump points on the path never get expanded, their costs are
+        // filled in so they can still be described
+
+        std::vector<std::uint32_t> waypoints{};
+        for (auto ind = static_cast<std::int32_t>(end_ind); parents[ind] != -1; ind = parents[ind]) {
+            waypoints.push_back(ind);
+
+            Point from = grid.point(parents[ind]);
+            Point to = grid.point(ind);
+            Point dir{sign(to.first - from.first), sign(to.second - from.second)};
+            int g_cost = g_costs[parents[ind]];
+            for (Point cur = from + dir; cur != to; cur = cur + dir) {
+                g_cost += (dir.first != 0 && dir.second != 0) ? 14 : 10;
+                result.set_costs(grid.index(cur), g_cost, heuristic(cur, end_point));
+            }
+        }
+        waypoints.push_back(static_cast<std::uint32_t>(start_ind));
+        std::reverse(waypoints.begin(), waypoints.end());
+        result.set_path(waypoints);
+
+        PF2_PROBE_ELAPSED(result.stats(), probe_start);
+        return result;
+    }
+}
+
+SearchResult JumpPointSearch::find_path(const Grid &grid) {
+    Neighbourhood neighbourhood{grid};
+
+    // straight scans only stop on forced neighbours, diagonal scans also stop when one of their
+    // straight components would
+    auto jump_straight = [&](std::size_t ind, Point dir, std::size_t end_ind) {
+        const std::ptrdiff_t step = grid.offset(dir);
+        for (;;) {
+            ind += step;
+            if (!grid.walkable(ind))
+                return Grid::npos;
+            if (ind == end_ind || neighbourhood.has_forced(ind, dir))
+                return ind;
+        }
+    };
+
+    auto jump = [&](std::size_t ind, Point dir, std::size_t end_ind) {
+        if (dir.first == 0 || dir.second == 0)
+            return jump_straight(ind, dir, end_ind);
+
+        const std::ptrdiff_t step = grid.offset(dir);
+        for (;;) {
+            ind += step;
+            if (!grid.walkable(ind))
+                return Grid::npos;
+            if (ind == end_ind || neighbourhood.has_forced(ind, dir))
+                return ind;
+            if (jump_straight(ind, {dir.first, 0}, end_ind) != Grid::npos ||
+                    jump_straight(ind, {0, dir.second}, end_ind) != Grid::npos)
+                return ind;
+        }
+    };
+
+    return search_jump_points(grid, jump);
+}
+
+void JumpPointSearchPlus::precompute(const Grid &grid) {
+    // jump_dists[cell * 8 + dir] is the number of steps to the next jump point in that
+    // direction, or minus the number of steps that can be taken before hitting a wall
+
+    Neighbourhood neighbourhood{grid};
+    const int width = grid.width();
+    const int height = grid.height();
+    jump_dists.assign(grid.padded_size() * directions.size(), 0);
+
+    auto compute = [&](Point cell, int dir_ind) {
+        Point dir = directions[dir_ind];
+        std::size_t ind = grid.index(cell);
+        std::size_t next_ind = ind + grid.offset(dir);
+        if (!grid.walkable(ind) || !grid.walkable(next_ind))
+            return;
+
+        bool is_jump_point = neighbourhood.has_forced(next_ind, dir);
+        if (dir.first != 0 && dir.second != 0) {
+            is_jump_point = is_jump_point ||
+                jump_dists[next_ind * 8 + direction_ind({dir.first, 0})] > 0 ||
+                jump_dists[next_ind * 8 + direction_ind({0, dir.second})] > 0;
+        }
+
+        std::int32_t next_dist = jump_dists[next_ind * 8 + dir_ind];
+        if (is_jump_point)
+            jump_dists[ind * 8 + dir_ind] = 1;
+        else
+            jump_dists[ind * 8 + dir_ind] = next_dist > 0 ? next_dist + 1 : next_dist - 1;
+    };
+
+    // every cell depends on the one after it in the same direction so each direction sweeps
+    // from the far side, diagonals go last since they read the straight distances
+    for (int dir_ind = 0; dir_ind < static_cast<int>(directions.size()); dir_ind++) {
+        auto [dx, dy] = directions[dir_ind];
+        for (int row = 0; row < height; row++) {
+            int y = dy > 0 ? height - 1 - row : row;
+            for (int col = 0; col < width; col++) {
+                int x = dx > 0 ? width - 1 - col : col;
+                compute({x, y}, dir_ind);
+            }
+        }
+    }
+
+    tables_shape = grid.shape();
+    tables_revision = grid.revision();
+}
+
+SearchResult JumpPointSearchPlus::find_path(const Grid &grid) {
+    // the tables only depend on where the obsticals are, which the revision tracks without
+    // having to look at the grid
+    if (jump_dists.empty() || grid.shape() != tables_shape || grid.revision() != tables_revision)
+        precompute(grid);
+
+    std::size_t end_ind = grid.find(Node::End);
+    if (end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+    const Point end_point = grid.point(end_ind);
+
+    auto jump = [&](std::size_t ind, Point dir, std::size_t end_ind) {
+        std::int32_t jump_dist = jump_dists[ind * 8 + direction_ind(dir)];
+        int reach = std::abs(jump_dist);
+        Point point = grid.point(ind);
+        int to_end_x = end_point.first - point.first;
+        int to_end_y = end_point.second - point.second;
+
+        // the end can sit before the next jump point, in which case it's the target itself (or
+        // for diagonals the cell lined up with it that a straight jump will reach the end from)
+        if (dir.first == 0 || dir.second == 0) {
+            int steps = dir.first != 0 ? to_end_x * dir.first : to_end_y * dir.second;
+            bool in_line = dir.first != 0 ? to_end_y == 0 : to_end_x == 0;
+            if (in_line && steps > 0 && steps <= reach)
+                return end_ind;
+        }
+        else if (sign(to_end_x) == dir.first && sign(to_end_y) == dir.second) {
+            int steps = std::min(std::abs(to_end_x), std::abs(to_end_y));
+            if (steps <= reach)
+                return static_cast<std::size_t>(ind + steps * grid.offset(dir));
+        }
+
+        if (jump_dist <= 0)
+            return Grid::npos;
+        return static_cast<std::size_t>(ind + jump_dist * grid.offset(dir));
+    };
+
+    return search_jump_points(grid, jump);
+}
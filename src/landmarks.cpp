@@ -0,0 +1,212 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include "landmarks.hpp"
+#include "components.hpp"
+#include "open_list.hpp"
+
+using namespace pathfinder2;
+
+namespace {
+    constexpr char table_magic[8] = {'P', 'F', '2', 'A', 'L', 'T', '\0', '\0'};
+    constexpr std::uint32_t table_version = 1;
+
+    // distances are read this many at a time, so a table that claims more than the file holds
+    // runs out before it can allocate all of it
+    constexpr std::size_t read_chunk = 1 << 20;
+
+    // fnv-1a over the obstical bits, tells tables built for different maps apart
+    std::uint64_t hash_obsticals(const Grid &grid) {
+        BitGrid bits = grid.obstacle_bitmap();
+        std::uint64_t hash = 0xcbf29ce484222325;
+        for (std::size_t i = 0; i < bits.word_count(); i++) {
+            hash ^= bits.data()[i];
+            hash *= 0x100000001b3;
+        }
+        return hash;
+    }
+
+    // dijkstra with the same moves and costs as the searches
+    void distances_from(const Grid &grid, std::size_t source, std::vector<std::uint32_t> &dists,
+            IndexedBinaryHeap<std::uint32_t> &open_list) {
+        std::fill(dists.begin(), dists.end(), LandmarkTable::unreachable);
+        open_list.clear();
+
+        dists[source] = 0;
+        open_list.push_or_decrease(static_cast<std::uint32_t>(source), 0);
+
+        while (!open_list.empty()) {
+            auto [ind, dist] = open_list.pop();
+            for (const auto &step : EightConnected::steps) {
+                std::size_t next = ind + grid.offset(step.offset());
+                std::uint32_t next_dist = dist + static_cast<std::uint32_t>(step.cost);
+                if (grid.walkable(next) && next_dist < dists[next]) {
+                    dists[next] = next_dist;
+                    open_list.push_or_decrease(static_cast<std::uint32_t>(next), next_dist);
+                }
+            }
+        }
+    }
+
+    template <typename T>
+    void write_pod(std::ostream &out, const T &val) {
+        out.write(reinterpret_cast<const char *>(&val), sizeof(val));
+    }
+
+    template <typename T>
+    void read_pod(std::istream &in, T &val) {
+        in.read(reinterpret_cast<char *>(&val), sizeof(val));
+    }
+}
+
+LandmarkTable::LandmarkTable(const Grid &grid, int landmark_cnt) :
+    grid_shape{grid.shape()},
+    obstacle_hash{hash_obsticals(grid)}
+{
+    // the landmarks go into the biggest region, that's where the long queries are
+
+    ComponentIndex components{grid};
+    std::vector<std::uint32_t> region_sizes{};
+    for (int y = 0; y < grid.height(); y++) {
+        for (int x = 0; x < grid.width(); x++) {
+            std::uint32_t label = components.component({x, y});
+            if (label >= region_sizes.size())
+                region_sizes.resize(label + 1, 0);
+            region_sizes[label]++;
+        }
+    }
+
+    std::size_t seed = Grid::npos;
+    if (region_sizes.size() > 1) {
+        auto biggest = static_cast<std::uint32_t>(std::max_element(region_sizes.begin() + 1, region_sizes.end()) - region_sizes.begin());
+        for (int y = 0; y < grid.height() && seed == Grid::npos; y++) {
+            for (int x = 0; x < grid.width() && seed == Grid::npos; x++) {
+                if (components.component({x, y}) == biggest)
+                    seed = grid.index({x, y});
+            }
+        }
+    }
+
+    if (seed == Grid::npos || landmark_cnt <= 0)
+        return; // nothing walkable
+    landmark_cnt = std::min(landmark_cnt, max_landmark_cnt);
+
+    // farthest point selection: the first landmark is the cell farthest from some cell of the
+    // region, each next one the cell farthest from all landmarks so far
+
+    std::vector<std::uint32_t> from_landmark(grid.padded_size());
+    std::vector<std::uint32_t> closest(grid.padded_size(), unreachable);
+    IndexedBinaryHeap<std::uint32_t> open_list{grid.padded_size()};
+
+    auto farthest = [&](const std::vector<std::uint32_t> &costs) {
+        std::size_t best = Grid::npos;
+        for (std::size_t ind = 0; ind < costs.size(); ind++) {
+            if (costs[ind] != unreachable && (best == Grid::npos || costs[ind] > costs[best]))
+                best = ind;
+        }
+        return best;
+    };
+
+    distances_from(grid, seed, from_landmark, open_list);
+    std::size_t next = farthest(from_landmark);
+
+    // the dijkstras produce a column per landmark, lookups want the landmarks side by side per
+    // cell so each column gets spread out as it comes in
+    const auto stride = static_cast<std::size_t>(landmark_cnt);
+    dists.assign(grid.padded_size() * stride, unreachable);
+
+    for (std::size_t l = 0; l < stride; l++) {
+        // a region smaller than the landmark count runs out of new cells
+        if (std::find(landmark_cells.begin(), landmark_cells.end(), next) != landmark_cells.end())
+            break;
+
+        landmark_cells.push_back(static_cast<std::uint32_t>(next));
+        distances_from(grid, next, from_landmark, open_list);
+
+        for (std::size_t ind = 0; ind < closest.size(); ind++) {
+            dists[ind * stride + l] = from_landmark[ind];
+            closest[ind] = std::min(closest[ind], from_landmark[ind]);
+        }
+        next = farthest(closest);
+    }
+
+    // close the gaps the missing landmarks left
+    const std::size_t cnt = landmark_cells.size();
+    if (cnt < stride) {
+        for (std::size_t ind = 1; ind < grid.padded_size(); ind++)
+            std::copy(dists.begin() + ind * stride, dists.begin() + ind * stride + cnt, dists.begin() + ind * cnt);
+        dists.resize(grid.padded_size() * cnt);
+        dists.shrink_to_fit();
+    }
+}
+
+bool LandmarkTable::matches(const Grid &grid) const {
+    return grid.shape() == grid_shape && hash_obsticals(grid) == obstacle_hash;
+}
+
+void LandmarkTable::save(std::ostream &out) const {
+    out.write(table_magic, sizeof(table_magic));
+    write_pod(out, table_version);
+    write_pod(out, static_cast<std::int32_t>(grid_shape.width()));
+    write_pod(out, static_cast<std::int32_t>(grid_shape.height()));
+    write_pod(out, static_cast<std::uint32_t>(landmark_cells.size()));
+    write_pod(out, obstacle_hash);
+    out.write(reinterpret_cast<const char *>(landmark_cells.data()),
+            static_cast<std::streamsize>(landmark_cells.size() * sizeof(landmark_cells[0])));
+    out.write(reinterpret_cast<const char *>(dists.data()), static_cast<std::streamsize>(dists.size() * sizeof(dists[0])));
+
+    if (!out)
+        throw std::runtime_error("failed writing landmark table");
+}
+
+LandmarkTable LandmarkTable::load(std::istream &in) {
+    char magic[sizeof(table_magic)]{};
+    std::uint32_t version = 0, cnt = 0;
+    std::int32_t width = 0, height = 0;
+
+    in.read(magic, sizeof(magic));
+    read_pod(in, version);
+    read_pod(in, width);
+    read_pod(in, height);
+    read_pod(in, cnt);
+
+    if (!in || std::memcmp(magic, table_magic, sizeof(magic)) != 0 || version != table_version)
+        throw std::runtime_error("not a landmark table");
+    if (width <= 0 || height <= 0)
+        throw std::runtime_error("bad landmark table dimensions");
+    if (cnt > max_landmark_cnt)
+        throw std::runtime_error("too many landmarks in landmark table");
+
+    LandmarkTable table{};
+    table.grid_shape = {width, height};
+    const std::size_t padded_size = table.grid_shape.padded_size();
+    if (cnt != 0 && padded_size > SIZE_MAX / sizeof(std::uint32_t) / cnt)
+        throw std::runtime_error("bad landmark table dimensions");
+
+    read_pod(in, table.obstacle_hash);
+    table.landmark_cells.resize(cnt);
+    in.read(reinterpret_cast<char *>(table.landmark_cells.data()),
+            static_cast<std::streamsize>(table.landmark_cells.size() * sizeof(table.landmark_cells[0])));
+    if (!in)
+        throw std::runtime_error("truncated landmark table");
+
+    // the distances are looked up by these, so they have to be cells of the grid
+    for (auto cell : table.landmark_cells) {
+        if (cell >= padded_size || !table.grid_shape.in_bounds(table.grid_shape.point(cell)))
+            throw std::runtime_error("landmark outside of the landmark table's grid");
+    }
+
+    const std::size_t dist_cnt = padded_size * cnt;
+    for (std::size_t read = 0; read < dist_cnt && in;) {
+        std::size_t chunk = std::min(read_chunk, dist_cnt - read);
+        table.dists.resize(read + chunk);
+        in.read(reinterpret_cast<char *>(table.dists.data() + read), static_cast<std::streamsize>(chunk * sizeof(table.dists[0])));
+        read += chunk;
+    }
+
+    if (!in)
+        throw std::runtime_error("truncated landmark table");
+
+    return table;
+}
@@ -0,0 +1,201 @@
+#include <stdexcept>
+#include <vector>
+#include <algorithm>
+#include <climits>
+#include "pathing.hpp"
+#include "node.hpp"
+#include "grid.hpp"
+#include "search_kernel.hpp"
+
+using namespace pathfinder2;
+
+// the g cost of a cell is its current best known cost, rhs is the cost one step of lookahead
+// promises (min over the neighbours of their g plus the step). cells where they differ are
+// inconsistent and sit in the open list until they're fixed, an edit only makes the cells around
+// it inconsistent so only those get looked at again.
+
+namespace {
+    constexpr int inf = INT_MAX / 2;
+
+    constexpr auto &steps = EightConnected::steps;
+
+    // lpa* needs a consistent heuristic, octile distance is exactly the obstical free cost
+    int heuristic(Point point, Point end_point) {
+        return OctileHeuristic::distance(point, end_point);
+    }
+}
+
+void LifelongPlanningAStar::reset(const Grid &grid) {
+    planned_shape = grid.shape();
+    planned_revision = grid.revision();
+    start_ind = grid.find(Node::Start);
+    end_ind = grid.find(Node::End);
+
+    g_costs.assign(grid.padded_size(), inf);
+    rhs_costs.assign(grid.padded_size(), inf);
+    open_list.reset(grid.padded_size());
+    if (expanded.size() != grid.padded_size())
+        expanded = BitGrid{grid.padded_size()};
+
+    rhs_costs[start_ind] = 0;
+    open_list.push_or_decrease(static_cast<std::uint32_t>(start_ind), calculate_key(grid, start_ind));
+}
+
+LifelongPlanningAStar::Key LifelongPlanningAStar::calculate_key(const Grid &grid, std::size_t ind) const {
+    int cost = std::min(g_costs[ind], rhs_costs[ind]);
+    return {cost + heuristic(grid.point(ind), grid.point(end_ind)), cost};
+}
+
+void LifelongPlanningAStar::update_cell(const Grid &grid, std::size_t ind) {
+    if (ind != start_ind) {
+        int rhs = inf;
+        if (grid.walkable(ind)) {
+            for (const auto &step : steps) {
+                std::size_t pred_ind = ind + grid.offset(step.offset());
+                if (grid.walkable(pred_ind) && g_costs[pred_ind] != inf)
+                    rhs = std::min(rhs, g_costs[pred_ind] + step.cost);
+            }
+        }
+        if (rhs < rhs_costs[ind] && rhs_costs[ind] != inf)
+            PF2_PROBE(search_stats, reparents, 1);
+        rhs_costs[ind] = rhs;
+    }
+
+    if (g_costs[ind] != rhs_costs[ind]) {
+        if (!open_list.contains(static_cast<std::uint32_t>(ind)))
+            PF2_PROBE(search_stats, pushed, 1);
+        open_list.update(static_cast<std::uint32_t>(ind), calculate_key(grid, ind));
+    }
+    else {
+        open_list.remove(static_cast<std::uint32_t>(ind));
+    }
+    PF2_PROBE(search_stats, heap_ops, 1);
+}
+
+void LifelongPlanningAStar::compute_shortest_path(const Grid &grid) {
+    while (!open_list.empty() &&
+            (open_list.top().second < calculate_key(grid, end_ind) || rhs_costs[end_ind] != g_costs[end_ind]))
+    {
+        auto [current_ind, key] = open_list.pop();
+        PF2_PROBE(search_stats, heap_ops, 1);
+        PF2_PROBE(search_stats, expanded, 1);
+
+        if (!expanded.test(current_ind)) {
+            expanded.set(current_ind);
+            expanded_order.push_back(current_ind);
+        }
+
+        if (g_costs[current_ind] > rhs_costs[current_ind]) {
+            // overconsistent, the cell got cheaper so settle it like plain A* would
+            g_costs[current_ind] = rhs_costs[current_ind];
+        }
+        else {
+            // underconsistent, the cell got more expensive so drop it and let its rhs rebuild it
+            g_costs[current_ind] = inf;
+            update_cell(grid, current_ind);
+        }
+
+        for (const auto &step : steps) {
+            std::size_t succ_ind = current_ind + grid.offset(step.offset());
+            if (grid.walkable(succ_ind))
+                update_cell(grid, succ_ind);
+        }
+    }
+}
+
+void LifelongPlanningAStar::cell_changed(const Grid &grid, Point p) {
+    if (start_ind == Grid::npos || grid.shape() != planned_shape)
+        return;
+
+    // with an edit in between that wasn't reported the tree can't be repaired around p alone,
+    // the revision stays behind and the next search starts over. the start or end moving
+    // doesn't change the revision.
+    if (grid.revision() != planned_revision) {
+        if (!grid.follows(planned_revision, p))
+            return;
+        planned_revision = grid.revision();
+    }
+
+    // the edges into and out of the cell changed, so did the rhs of it and its neighbours
+    std::size_t ind = grid.index(p);
+    update_cell(grid, ind);
+    for (const auto &step : steps) {
+        std::size_t neighbour_ind = ind + grid.offset(step.offset());
+        if (grid.walkable(neighbour_ind))
+            update_cell(grid, neighbour_ind);
+    }
+}
+
+SearchResult LifelongPlanningAStar::find_path(const Grid &grid) {
+    SearchResult result{};
+    find_path(grid, result);
+    return result;
+}
+
+void LifelongPlanningAStar::find_path(const Grid &grid, SearchResult &result) {
+    PF2_PROBE_TIMER(probe_start);
+
+    // the tree is rooted at the start and keyed on the distance to the end, moving either means
+    // starting over. so do edits that weren't reported. the grid only gets scanned for the start
+    // and end when they aren't where they were.
+    bool replan = start_ind == Grid::npos ||
+        grid.shape() != planned_shape ||
+        grid.revision() != planned_revision ||
+        grid[start_ind] != Node::Start ||
+        grid[end_ind] != Node::End;
+    if (replan && (grid.find(Node::Start) == Grid::npos || grid.find(Node::End) == Grid::npos))
+        throw std::invalid_argument("No start and/or end point");
+
+    // only the bits the last call set get cleared, a reset() for another shape makes new ones
+    for (auto ind : expanded_order)
+        expanded.reset(ind);
+    expanded_order.clear();
+    if (replan)
+        reset(grid);
+
+    compute_shortest_path(grid);
+
+    // only the cells this call had to look at are reported as visited
+
+    result.reset(grid.shape());
+    const Point end_point = grid.point(end_ind);
+    for (auto ind : expanded_order)
+        result.mark_visited(ind, g_costs[ind], heuristic(grid.point(ind), end_point));
+
+    // the repairs cell_changed() queued up since the last search are counted with this one
+    PF2_PROBE_SET(search_stats, peak_scratch_bytes,
+            g_costs.capacity() * sizeof(g_costs[0]) + rhs_costs.capacity() * sizeof(rhs_costs[0]) +
+            open_list.memory_bytes() + expanded.word_count() * sizeof(std::uint64_t) +
+            expanded_order.capacity() * sizeof(expanded_order[0]));
+    result.stats() = search_stats;
+    search_stats = {};
+
+    if (g_costs[end_ind] == inf) {
+        PF2_PROBE_ELAPSED(result.stats(), probe_start);
+        return; // no possible way to endpoint
+    }
+
+    // walk back from the end always taking the predecessor the end's cost came through
+
+    waypoints.assign(1, static_cast<std::uint32_t>(end_ind));
+    for (std::size_t ind = end_ind; ind != start_ind;) {
+        std::size_t best_ind = Grid::npos;
+        int best_cost = inf;
+        for (const auto &step : steps) {
+            std::size_t pred_ind = ind + grid.offset(step.offset());
+            if (grid.walkable(pred_ind) && g_costs[pred_ind] != inf && g_costs[pred_ind] + step.cost < best_cost) {
+                best_cost = g_costs[pred_ind] + step.cost;
+                best_ind = pred_ind;
+            }
+        }
+
+        ind = best_ind;
+        waypoints.push_back(static_cast<std::uint32_t>(ind));
+        result.set_costs(ind, g_costs[ind], heuristic(grid.point(ind), end_point));
+    }
+
+    std::reverse(waypoints.begin(), waypoints.end());
+    result.set_path(waypoints);
+
+    PF2_PROBE_ELAPSED(result.stats(), probe_start);
+}
@@ -1,14 +1,64 @@
 #include <SDL2/SDL.h>
 #include <SDL2/SDL_ttf.h>
+#include <cstdlib>
 #include <iostream>
+#include <string>
 #include "node.hpp"
 #include "graphics.hpp"
 
-int main() {
+namespace {
+    void print_usage(const char *argv0) {
+        std::cerr << "usage: " << argv0 << " [--map FILE | [--size WxH] [--seed N] [--maze backtracker|eller]]\n";
+    }
+
+    bool parse_options(int argc, char **argv, pathfinder2::ui::Options &opts) {
+        for (int i = 1; i < argc; i++) {
+            std::string arg = argv[i];
+            if (arg == "--size" && i + 1 < argc) {
+                char *end = nullptr;
+                const char *cur = argv[++i];
+                opts.grid_width = static_cast<int>(std::strtol(cur, &end, 10));
+                if (end == cur || *end != 'x')
+                    return false;
+                cur = end + 1;
+                opts.grid_height = static_cast<int>(std::strtol(cur, &end, 10));
+                if (end == cur || *end != '\0' || opts.grid_width <= 0 || opts.grid_height <= 0)
+                    return false;
+            }
+            else if (arg == "--map" && i + 1 < argc) {
+                opts.map_path = argv[++i];
+            }
+            else if (arg == "--seed" && i + 1 < argc) {
+                opts.seed = static_cast<std::uint32_t>(std::strtoul(argv[++i], nullptr, 10));
+            }
+            else if (arg == "--maze" && i + 1 < argc) {
+                std::string maze = argv[++i];
+                if (maze == "backtracker")
+                    opts.maze = pathfinder2::MazeAlgorithm::Backtracker;
+                else if (maze == "eller")
+                    opts.maze = pathfinder2::MazeAlgorithm::Eller;
+                else
+                    return false;
+            }
+            else {
+                return false;
+            }
+        }
+        return true;
+    }
+}
+
+int main(int argc, char **argv) {
+    pathfinder2::ui::Options opts{};
+    if (!parse_options(argc, argv, opts)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
     int rc = 0;
 
     try {
-        rc = pathfinder2::ui::run();
+        rc = pathfinder2::ui::run(opts);
     }
     catch (std::runtime_error &e) {
         std::cerr << "Fatal error: " << e.what() << "\n";
@@ -0,0 +1,230 @@
+#include <algorithm>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <utility>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "map_io.hpp"
+
+using namespace pathfinder2;
+
+namespace {
+    constexpr char map_magic[8] = {'P', 'F', '2', 'M', 'A', 'P', '\0', '\0'};
+    constexpr std::uint32_t map_version = 1;
+
+    std::size_t words_for(int width) {
+        return (static_cast<std::size_t>(width) + 63) / 64;
+    }
+
+    void write_map_header(std::ostream &out, int width, int height) {
+        MapFileHeader header{};
+        std::memcpy(header.magic, map_magic, sizeof(map_magic));
+        header.version = map_version;
+        header.width = static_cast<std::uint32_t>(width);
+        header.height = static_cast<std::uint32_t>(height);
+        header.words_per_row = static_cast<std::uint32_t>(words_for(width));
+        out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+    }
+
+    // header is "type <name>", "height <h>", "width <w>" and "map", only the sizes matter
+    std::pair<int, int> read_movingai_header(std::istream &in) {
+        int width = 0, height = 0;
+        for (std::string key; in >> key && key != "map";) {
+            if (key == "height")
+                in >> height;
+            else if (key == "width")
+                in >> width;
+            else
+                in >> key;
+        }
+
+        if (!in || width <= 0 || height <= 0)
+            throw std::runtime_error("bad MovingAI map header");
+
+        std::string rest{};
+        std::getline(in, rest); // rest of the "map" line
+        return {width, height};
+    }
+
+    // reads the next row into line, at least width long
+    void read_movingai_row(std::istream &in, std::string &line, int width) {
+        if (!std::getline(in, line))
+            throw std::runtime_error("MovingAI map ends early");
+        if (!line.empty() && line.back() == '\r')
+            line.pop_back();
+        if (static_cast<int>(line.size()) < width)
+            throw std::runtime_error("MovingAI map row too short");
+    }
+
+    bool movingai_blocked(char terrain) {
+        switch (terrain) {
+            case '.': case 'G': case 'S':
+                return false;
+            case '@': case 'O': case 'T': case 'W':
+                return true;
+            default:
+                throw std::runtime_error("unknown MovingAI map terrain");
+        }
+    }
+}
+
+Grid BitPlane::to_grid() const {
+    Grid grid{plane_width, plane_height};
+    for (int y = 0; y < plane_height; y++)
+        grid.assign_row(y, row(y));
+    return grid;
+}
+
+MappedMap::MappedMap(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0)
+        throw std::runtime_error("failed opening map " + path);
+
+    struct stat info{};
+    if (::fstat(fd, &info) < 0 || static_cast<std::size_t>(info.st_size) < sizeof(MapFileHeader)) {
+        ::close(fd);
+        throw std::runtime_error("map file too small " + path);
+    }
+
+    mapping_size = static_cast<std::size_t>(info.st_size);
+    mapping = ::mmap(nullptr, mapping_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        mapping = nullptr;
+        throw std::runtime_error("failed mapping map " + path);
+    }
+
+    // checked before the plane gets pointed into the mapping
+
+    MapFileHeader header;
+    std::memcpy(&header, mapping, sizeof(header));
+
+    const char *error = nullptr;
+    if (std::memcmp(header.magic, map_magic, sizeof(map_magic)) != 0)
+        error = "not a binary map ";
+    else if (header.version != map_version)
+        error = "unsupported map version ";
+    else if (header.width == 0 || header.height == 0 || header.width > INT32_MAX || header.height > INT32_MAX ||
+            header.words_per_row != words_for(static_cast<int>(header.width)))
+        error = "bad map dimensions ";
+    else if (mapping_size < sizeof(header) + std::size_t{header.words_per_row} * header.height * sizeof(std::uint64_t))
+        error = "truncated map ";
+
+    if (error != nullptr) {
+        ::munmap(mapping, mapping_size);
+        mapping = nullptr;
+        throw std::runtime_error(error + path);
+    }
+
+    // the header is a multiple of 8 bytes long and mmap hands out page aligned memory
+    static_assert(sizeof(MapFileHeader) % alignof(std::uint64_t) == 0);
+    bit_plane = {
+        reinterpret_cast<const std::uint64_t *>(static_cast<const char *>(mapping) + sizeof(header)),
+        static_cast<int>(header.width),
+        static_cast<int>(header.height),
+        header.words_per_row,
+    };
+}
+
+MappedMap::~MappedMap() {
+    if (mapping != nullptr)
+        ::munmap(mapping, mapping_size);
+}
+
+void pathfinder2::write_binary_map(std::ostream &out, const Grid &grid) {
+    write_map_header(out, grid.width(), grid.height());
+
+    std::vector<std::uint64_t> row(words_for(grid.width()));
+    for (int y = 0; y < grid.height(); y++) {
+        std::fill(row.begin(), row.end(), 0);
+        for (int x = 0; x < grid.width(); x++) {
+            if (grid[Point{x, y}] == Node::Obstical)
+                row[x / 64] |= std::uint64_t{1} << (x % 64);
+        }
+        out.write(reinterpret_cast<const char *>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(row[0])));
+    }
+
+    if (!out)
+        throw std::runtime_error("failed writing map");
+}
+
+void pathfinder2::convert_movingai_map(std::istream &in, std::ostream &out) {
+    auto [width, height] = read_movingai_header(in);
+    write_map_header(out, width, height);
+
+    std::string line{};
+    std::vector<std::uint64_t> row(words_for(width));
+    for (int y = 0; y < height; y++) {
+        read_movingai_row(in, line, width);
+        std::fill(row.begin(), row.end(), 0);
+        for (int x = 0; x < width; x++) {
+            if (movingai_blocked(line[x]))
+                row[x / 64] |= std::uint64_t{1} << (x % 64);
+        }
+        out.write(reinterpret_cast<const char *>(row.data()), static_cast<std::streamsize>(row.size() * sizeof(row[0])));
+    }
+
+    if (!out)
+        throw std::runtime_error("failed writing map");
+}
+
+Grid pathfinder2::read_movingai_map(std::istream &in) {
+    auto [width, height] = read_movingai_header(in);
+
+    Grid grid{width, height};
+    std::string line{};
+    for (int y = 0; y < height; y++) {
+        read_movingai_row(in, line, width);
+        for (int x = 0; x < width; x++) {
+            if (movingai_blocked(line[x]))
+                grid.set({x, y}, Node::Obstical);
+        }
+    }
+
+    return grid;
+}
+
+std::vector<Scenario> pathfinder2::read_movingai_scen(std::istream &in) {
+    std::string line{};
+    if (!std::getline(in, line) || line.rfind("version", 0) != 0)
+        throw std::runtime_error("bad MovingAI scenario header");
+
+    std::vector<Scenario> scenarios{};
+    while (std::getline(in, line)) {
+        if (line.empty() || line == "\r")
+            continue;
+
+        Scenario scen{};
+        std::istringstream fields{line};
+        fields >> scen.bucket >> scen.map >> scen.map_width >> scen.map_height
+            >> scen.start.first >> scen.start.second >> scen.end.first >> scen.end.second >> scen.optimal_length;
+        if (!fields)
+            throw std::runtime_error("bad MovingAI scenario line");
+
+        scenarios.push_back(std::move(scen));
+    }
+
+    return scenarios;
+}
+
+Grid pathfinder2::load_map(const std::string &path) {
+    std::ifstream in{path, std::ios::binary};
+    if (!in)
+        throw std::runtime_error("failed opening map " + path);
+
+    char magic[sizeof(map_magic)]{};
+    in.read(magic, sizeof(magic));
+    if (in && std::memcmp(magic, map_magic, sizeof(map_magic)) == 0) {
+        in.close();
+        MappedMap mapped{path};
+        return mapped.plane().to_grid();
+    }
+
+    in.clear();
+    in.seekg(0);
+    return read_movingai_map(in);
+}
@@ -1,68 +1,237 @@
 #include <random>
 #include <array>
 #include <vector>
-#include <stack>
+#include <string>
 #include <stdexcept>
-#include <optional>
 #include <algorithm>
-#include <set>
-#include <iterator>
-#include <iostream>
 #include "maze.hpp"
 #include "node.hpp"
+#include "grid.hpp"
 
 using namespace pathfinder2;
 
-void pathfinder2::generate_maze(NodeMatrix &matrix) {
-    // simple random depth first search
-    
-    std::mt19937 rand{std::random_device{}()};
-    std::stack<Point> return_stack{};
-    std::vector<Point> dir_opts{};
-    std::set<Point> visited_nodes{};
-    return_stack.push({0, 0});
-
-    while (!return_stack.empty()) {
-        auto cur_node = return_stack.top();
-        visited_nodes.insert(cur_node);
-
-        std::vector<Point> wall_nodes_offsets {
-            Point{-1, -1}, Point{-1, 0}, Point{-1, 1}, Point{0, 1},
-            Point{0, -1}, Point{1, -1}, Point{1, 0}, Point{1, 1},
-        };
+namespace {
+    // hands out single random bits so coin flips don't burn a whole mt19937 call each
+    class RandomBits {
+    public:
+        explicit RandomBits(std::uint32_t seed) : rand{seed} {}
 
-        dir_opts.clear();
-        for (std::size_t i = 0; i < wall_nodes_offsets.size(); i++) {
-            auto cur_wall_node = cur_node + wall_nodes_offsets[i];
-            if (cur_wall_node.first < 0 ||
-                cur_wall_node.second < 0 ||
-                cur_wall_node.first >= static_cast<int>(matrix.size()) ||
-                cur_wall_node.second >= static_cast<int>(matrix[0].size()))
-            {
-                wall_nodes_offsets.erase(std::begin(wall_nodes_offsets) + i--);
-                continue;
+        bool next_bit() {
+            if (bits_left == 0) {
+                bits = rand();
+                bits_left = 32;
             }
+            bool bit = bits & 1;
+            bits >>= 1;
+            bits_left--;
+            return bit;
+        }
 
-            auto potential_node = cur_wall_node + wall_nodes_offsets[i];
-            bool is_in = visited_nodes.find(potential_node) != std::end(visited_nodes);
-            bool is_diagonal = wall_nodes_offsets[i].first != 0 && wall_nodes_offsets[i].second != 0;
+        std::uint32_t below(std::uint32_t bound) { return rand() % bound; }
 
-            if (!is_diagonal && !is_in)
-                //if (matrix[cur_wall_node.first][cur_wall_node.second] != Node::Obstical)
-                    dir_opts.push_back(wall_nodes_offsets[i]);
+    private:
+        std::mt19937 rand;
+        std::uint32_t bits = 0;
+        int bits_left = 0;
+    };
 
-            if (is_diagonal || !is_in)
-                matrix[cur_wall_node.first][cur_wall_node.second] = Node::Obstical;
-        }
+    void backtracker(Grid &grid, std::uint32_t seed) {
+        // cells live at even coordinates, (cell_x, cell_y) is grid point (2 * cell_x, 2 * cell_y).
+        // the stack only remembers which way each step went so it costs a byte per cell deep.
+
+        constexpr std::array<Point, 4> dirs = {{{1, 0}, {-1, 0}, {0, 1}, {0, -1}}};
+
+        const int cells_x = (grid.width() + 1) / 2;
+        const int cells_y = (grid.height() + 1) / 2;
+        RandomBits rand{seed};
+        std::vector<bool> visited(static_cast<std::size_t>(cells_x) * cells_y, false);
+        std::vector<std::uint8_t> return_stack{};
+
+        auto cell_ind = [cells_x](Point cell) { return static_cast<std::size_t>(cell.second) * cells_x + cell.first; };
+        auto carve = [&grid](Point point) { grid.set(point, Node::Walkable); };
 
-        if (dir_opts.empty()) {
-            return_stack.pop();
+        grid.fill(Node::Obstical);
+
+        Point cur{0, 0};
+        visited[0] = true;
+        carve({0, 0});
+
+        for (;;) {
+            std::array<std::uint8_t, 4> options{};
+            std::uint32_t option_cnt = 0;
+            for (std::uint8_t i = 0; i < dirs.size(); i++) {
+                Point next = cur + dirs[i];
+                if (next.first >= 0 && next.second >= 0 && next.first < cells_x && next.second < cells_y &&
+                        !visited[cell_ind(next)])
+                    options[option_cnt++] = i;
+            }
+
+            if (option_cnt == 0) {
+                if (return_stack.empty())
+                    break;
+
+                // step back the way we came
+                Point dir = dirs[return_stack.back()];
+                return_stack.pop_back();
+                cur = {cur.first - dir.first, cur.second - dir.second};
+                continue;
+            }
+
+            std::uint8_t dir_ind = options[rand.below(option_cnt)];
+            Point dir = dirs[dir_ind];
+            Point next = cur + dir;
+
+            carve({2 * cur.first + dir.first, 2 * cur.second + dir.second});
+            carve({2 * next.first, 2 * next.second});
+            visited[cell_ind(next)] = true;
+            return_stack.push_back(dir_ind);
+            cur = next;
         }
-        else {
-            auto dir = dir_opts[rand() % dir_opts.size()];
-            auto wall_node = cur_node + dir;
-            return_stack.push(wall_node + dir);
-            matrix[wall_node.first][wall_node.second] = Node::Walkable;
+    }
+
+    // eller's algorithm, emit_row(y, row) is called once for every grid row in order with the
+    // nodes of that row. only the set labels of the current row of cells are kept around.
+    template <typename EmitRow>
+    void eller(int width, int height, std::uint32_t seed, EmitRow &&emit_row) {
+        const int cells_x = (width + 1) / 2;
+        const int cells_y = (height + 1) / 2;
+        RandomBits rand{seed};
+
+        // labels index into parents, a union find that gets rebuilt for every row
+        std::vector<std::uint32_t> labels(cells_x), parents(2 * cells_x), remap(2 * cells_x);
+        std::vector<std::uint32_t> members(2 * cells_x);
+        std::vector<bool> went_down(2 * cells_x), carved_down(cells_x), joined_right(cells_x);
+        std::vector<Node> cell_row(width), wall_row(width);
+
+        auto find = [&](std::uint32_t label) {
+            while (parents[label] != label) {
+                parents[label] = parents[parents[label]];
+                label = parents[label];
+            }
+            return label;
+        };
+
+        for (int x = 0; x < cells_x; x++)
+            labels[x] = x;
+
+        for (int cell_y = 0; cell_y < cells_y; cell_y++) {
+            bool last_row = cell_y == cells_y - 1;
+            for (std::uint32_t i = 0; i < parents.size(); i++)
+                parents[i] = i;
+
+            // randomly join neighbours that aren't connected yet, the last row joins all of them
+            // so the whole maze ends up as one set
+            for (int x = 0; x + 1 < cells_x; x++) {
+                std::uint32_t left = find(labels[x]), right = find(labels[x + 1]);
+                joined_right[x] = left != right && (last_row || rand.next_bit());
+                if (joined_right[x])
+                    parents[right] = left;
+            }
+
+            for (int x = 0; x < cells_x; x++)
+                labels[x] = find(labels[x]);
+
+            // every set has to continue into the next row through at least one cell
+            std::fill(carved_down.begin(), carved_down.end(), false);
+            if (!last_row) {
+                std::fill(members.begin(), members.end(), 0);
+                std::fill(went_down.begin(), went_down.end(), false);
+                for (int x = 0; x < cells_x; x++)
+                    members[labels[x]]++;
+
+                for (int x = 0; x < cells_x; x++) {
+                    std::uint32_t label = labels[x];
+                    members[label]--;
+                    carved_down[x] = rand.next_bit() || (members[label] == 0 && !went_down[label]);
+                    if (carved_down[x])
+                        went_down[label] = true;
+                }
+            }
+
+            // emit the row of cells and the row of walls under it
+
+            std::fill(cell_row.begin(), cell_row.end(), Node::Obstical);
+            std::fill(wall_row.begin(), wall_row.end(), Node::Obstical);
+            for (int x = 0; x < cells_x; x++) {
+                cell_row[2 * x] = Node::Walkable;
+                if (x + 1 < cells_x && joined_right[x])
+                    cell_row[2 * x + 1] = Node::Walkable;
+                if (carved_down[x])
+                    wall_row[2 * x] = Node::Walkable;
+            }
+
+            emit_row(2 * cell_y, cell_row);
+            if (2 * cell_y + 1 < height)
+                emit_row(2 * cell_y + 1, wall_row);
+
+            // cells that weren't carved into start out in their own new set, labels get packed
+            // back into [0, 2 * cells_x) so the arrays never grow
+
+            std::fill(remap.begin(), remap.end(), UINT32_MAX);
+            std::uint32_t next_label = 0;
+            for (int x = 0; x < cells_x; x++) {
+                if (carved_down[x]) {
+                    if (remap[labels[x]] == UINT32_MAX)
+                        remap[labels[x]] = next_label++;
+                    labels[x] = remap[labels[x]];
+                }
+                else {
+                    labels[x] = UINT32_MAX;
+                }
+            }
+            for (int x = 0; x < cells_x; x++) {
+                if (labels[x] == UINT32_MAX)
+                    labels[x] = next_label++;
+            }
         }
     }
 }
+
+void pathfinder2::generate_maze(Grid &grid) {
+    generate_maze(grid, std::random_device{}());
+}
+
+void pathfinder2::generate_maze(Grid &grid, std::uint32_t seed) {
+    generate_maze(grid, MazeOptions{seed, MazeAlgorithm::Backtracker});
+}
+
+void pathfinder2::generate_maze(Grid &grid, const MazeOptions &options) {
+    switch (options.algorithm) {
+    case MazeAlgorithm::Backtracker:
+        backtracker(grid, options.seed);
+        break;
+    case MazeAlgorithm::Eller:
+        eller(grid.width(), grid.height(), options.seed, [&grid](int y, const std::vector<Node> &row) {
+            for (int x = 0; x < grid.width(); x++)
+                grid.set({x, y}, row[x]);
+        });
+        break;
+    }
+}
+
+void pathfinder2::write_maze(std::ostream &out, int width, int height, const MazeOptions &options) {
+    if (width <= 0 || height <= 0)
+        throw std::invalid_argument("Maze dimensions have to be positive");
+
+    out << "type octile\nheight " << height << "\nwidth " << width << "\nmap\n";
+
+    std::string line(static_cast<std::size_t>(width) + 1, '\n');
+    auto write_row = [&](const Node *row) {
+        for (int x = 0; x < width; x++)
+            line[x] = row[x] == Node::Obstical ? '@' : '.';
+        out.write(line.data(), static_cast<std::streamsize>(line.size()));
+    };
+
+    if (options.algorithm == MazeAlgorithm::Eller) {
+        eller(width, height, options.seed, [&](int, const std::vector<Node> &row) { write_row(row.data()); });
+    }
+    else {
+        Grid grid{width, height};
+        generate_maze(grid, options);
+        for (int y = 0; y < height; y++)
+            write_row(grid.data() + grid.index({0, y}));
+    }
+
+    if (!out)
+        throw std::runtime_error("failed writing maze");
+}
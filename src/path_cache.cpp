@@ -0,0 +1,234 @@
+#include <algorithm>
+#include <array>
+#include <format>
+#include <stdexcept>
+#include "path_cache.hpp"
+#include "search_kernel.hpp"
+
+using namespace pathfinder2;
+
+namespace {
+    std::uint64_t endpoints_key(std::size_t start_ind, std::size_t end_ind) {
+        return static_cast<std::uint64_t>(start_ind) << 32 | end_ind;
+    }
+
+    int octile(const GridShape &shape, std::size_t from, std::size_t to) {
+        return OctileHeuristic::distance(shape.point(from), shape.point(to));
+    }
+}
+
+std::string PathCacheStats::summary() const {
+    return std::format("cache hits: {} suffix hits: {} misses: {} invalidated: {}", hits, suffix_hits, misses, invalidated);
+}
+
+CachedPathing::CachedPathing(std::unique_ptr<PathingAlgorithm> algorithm, std::size_t capacity) :
+    inner{std::move(algorithm)}, capacity{capacity} {
+    if (!inner || capacity == 0)
+        throw std::invalid_argument("a path cache needs an algorithm and room for a path");
+}
+
+void CachedPathing::clear() {
+    counters.invalidated += entries.size();
+    entries.clear();
+    by_endpoints.clear();
+}
+
+void CachedPathing::sync(const Grid &grid) {
+    if (grid.shape() == grid_shape && grid.revision() == grid_revision)
+        return;
+
+    clear();
+    grid_shape = grid.shape();
+    grid_revision = grid.revision();
+}
+
+void CachedPathing::drop(std::size_t ind) {
+    by_endpoints.erase(endpoints_key(entries[ind].start, entries[ind].end));
+
+    // the last entry takes its place
+    if (ind + 1 != entries.size()) {
+        entries[ind] = std::move(entries.back());
+        by_endpoints[endpoints_key(entries[ind].start, entries[ind].end)] = ind;
+    }
+    entries.pop_back();
+}
+
+void CachedPathing::fill_result(const Entry &entry, std::size_t from, SearchResult &result) {
+    PF2_PROBE_TIMER(probe_start);
+    result.reset(grid_shape);
+    if (entry.cost < 0) {
+        PF2_PROBE_ELAPSED(result.stats(), probe_start);
+        return; // no possible way to endpoint
+    }
+
+    const int from_g_cost = entry.g_costs[from];
+    const int cost = entry.cost - from_g_cost;
+    waypoints.assign(entry.cells.begin() + static_cast<std::ptrdiff_t>(from), entry.cells.end());
+    for (std::size_t i = from; i < entry.cells.size(); i++) {
+        int g_cost = entry.g_costs[i] - from_g_cost;
+        result.set_costs(entry.cells[i], g_cost, cost - g_cost);
+    }
+    result.set_path(waypoints);
+    PF2_PROBE_ELAPSED(result.stats(), probe_start);
+}
+
+bool CachedPathing::lookup(const Grid &grid, std::size_t start_ind, std::size_t end_ind, SearchResult &result) {
+    sync(grid);
+    clock++;
+
+    if (auto found = by_endpoints.find(endpoints_key(start_ind, end_ind)); found != by_endpoints.end()) {
+        Entry &entry = entries[found->second];
+        entry.last_used = clock;
+        counters.hits++;
+        fill_result(entry, 0, result);
+        return true;
+    }
+
+    // any path to the same end that goes through the start
+    for (auto &entry : entries) {
+        if (entry.end != end_ind || entry.cost < 0)
+            continue;
+
+        auto on_path = std::lower_bound(entry.by_cell.begin(), entry.by_cell.end(), std::pair{static_cast<std::uint32_t>(start_ind), 0u});
+        if (on_path == entry.by_cell.end() || on_path->first != start_ind)
+            continue;
+
+        entry.last_used = clock;
+        counters.suffix_hits++;
+        fill_result(entry, on_path->second, result);
+        return true;
+    }
+
+    counters.misses++;
+    return false;
+}
+
+void CachedPathing::store(const Grid &grid, std::size_t start_ind, std::size_t end_ind, const SearchResult &result) {
+    // the search could have been on another revision if the grid changed while it ran
+    sync(grid);
+
+    if (entries.size() == capacity) {
+        auto oldest = std::min_element(entries.begin(), entries.end(),
+                [](const Entry &a, const Entry &b) { return a.last_used < b.last_used; });
+        drop(static_cast<std::size_t>(oldest - entries.begin()));
+    }
+
+    Entry entry{static_cast<std::uint32_t>(start_ind), static_cast<std::uint32_t>(end_ind), -1};
+    entry.last_used = clock;
+    if (result.found()) {
+        entry.cells.push_back(static_cast<std::uint32_t>(start_ind));
+        entry.g_costs.push_back(0);
+        result.for_each_path_point([&](Point p) {
+            Point prev = grid.point(entry.cells.back());
+            bool diagonal = p.first != prev.first && p.second != prev.second;
+            entry.cells.push_back(static_cast<std::uint32_t>(grid.index(p)));
+            entry.g_costs.push_back(entry.g_costs.back() + (diagonal ? 14 : 10));
+        });
+        entry.cost = entry.g_costs.back();
+
+        entry.by_cell.reserve(entry.cells.size());
+        for (std::size_t i = 0; i < entry.cells.size(); i++)
+            entry.by_cell.emplace_back(entry.cells[i], static_cast<std::uint32_t>(i));
+        std::sort(entry.by_cell.begin(), entry.by_cell.end());
+    }
+
+    by_endpoints[endpoints_key(start_ind, end_ind)] = entries.size();
+    entries.push_back(std::move(entry));
+}
+
+SearchResult CachedPathing::find_path(const Grid &grid) {
+    SearchResult result{};
+    find_path(grid, result);
+    return result;
+}
+
+void CachedPathing::find_path(const Grid &grid, SearchResult &result) {
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
+
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    was_hit = lookup(grid, start_ind, end_ind, result);
+    if (was_hit)
+        return;
+
+    inner->find_path(grid, result);
+    store(grid, start_ind, end_ind, result);
+}
+
+SearchTask CachedPathing::find_path_sliced(const Grid &grid, SearchResult &result) {
+    std::size_t start_ind = grid.find(Node::Start);
+    std::size_t end_ind = grid.find(Node::End);
+
+    if (start_ind == Grid::npos || end_ind == Grid::npos)
+        throw std::invalid_argument("No start and/or end point");
+
+    was_hit = lookup(grid, start_ind, end_ind, result);
+    if (was_hit)
+        co_return;
+
+    // the search goes on a slice at a time as before and gets cached once it's done, a
+    // cancelled one never makes it in
+    SearchTask search = inner->find_path_sliced(grid, result);
+    while (!search.run_for({}))
+        co_await SearchTask::yield();
+    store(grid, start_ind, end_ind, result);
+}
+
+void CachedPathing::cell_changed(const Grid &grid, Point p) {
+    inner->cell_changed(grid, p);
+
+    // the start or end moved, the paths are all still the shortest
+    if (grid.shape() != grid_shape || grid.revision() == grid_revision)
+        return;
+
+    // more than this edit happened since the last one reported, or p isn't the cell that changed
+    if (!grid.follows(grid_revision, p)) {
+        sync(grid);
+        return;
+    }
+    grid_revision = grid.revision();
+
+    const std::size_t ind = grid.index(p);
+    const bool opened = grid.walkable(ind);
+    const std::array<std::size_t, 4> sides = {
+        grid.index({p.first, p.second - 1}), grid.index({p.first + 1, p.second}),
+        grid.index({p.first, p.second + 1}), grid.index({p.first - 1, p.second}),
+    };
+    for (std::size_t i = entries.size(); i-- > 0;) {
+        const Entry &entry = entries[i];
+
+        // where cell is on the path, npos if it isn't
+        auto position = [&](std::size_t cell) {
+            auto found = std::lower_bound(entry.by_cell.begin(), entry.by_cell.end(), std::pair{static_cast<std::uint32_t>(cell), 0u});
+            return found != entry.by_cell.end() && found->first == cell ? std::size_t{found->second} : Grid::npos;
+        };
+
+        bool affected;
+        if (opened) {
+            // a new path has to go through p or diagonally past it through two of its sides, which
+            // is no shorter than the octile distance there and on to the end. blocked cells never
+            // made a path, opening one might
+            int shortest = octile(grid, entry.start, ind) + octile(grid, ind, entry.end);
+            for (auto side : sides)
+                shortest = std::min(shortest, octile(grid, entry.start, side) + octile(grid, side, entry.end));
+            affected = entry.cost < 0 || shortest < entry.cost;
+        }
+        else {
+            // blocking a cell only makes the paths that avoided it no longer. a path that steps
+            // diagonally past p has it as a corner, which isn't allowed to be blocked for
+            // algorithms that don't cut corners.
+            affected = position(ind) != Grid::npos;
+            for (std::size_t side = 0; side < sides.size() && !affected; side++) {
+                std::size_t a = position(sides[side]), b = position(sides[(side + 1) % sides.size()]);
+                affected = a != Grid::npos && b != Grid::npos && (a + 1 == b || b + 1 == a);
+            }
+        }
+
+        if (affected) {
+            drop(i);
+            counters.invalidated++;
+        }
+    }
+}
@@ -0,0 +1,29 @@
+#include <memory>
+#include <vector>
+#include "pathing.hpp"
+
+using namespace pathfinder2;
+
+SearchTask PathingAlgorithm::find_path_sliced(const Grid &grid, SearchResult &result) {
+    find_path(grid, result);
+    co_return;
+}
+
+const std::vector<PathingAlgorithmInfo> &pathfinder2::pathing_algorithms() {
+    static const std::vector<PathingAlgorithmInfo> algorithms = {
+        {"A*", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<AStar>(); }},
+        {"A* 4-way", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<AStar4>(); }},
+        {"A* no corners", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<AStarNoCorners>(); }},
+        {"A* radix heap", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<AStarRadix>(); }},
+        {"A* buckets", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<AStarBuckets>(); }},
+        {"ALT", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<AltAStar>(); }},
+        {"Wavefront A*", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<WavefrontAStar>(); }},
+        {"JPS", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<JumpPointSearch>(); }},
+        {"JPS+", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<JumpPointSearchPlus>(); }},
+        {"LPA*", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<LifelongPlanningAStar>(); }},
+        {"HPA*", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<HPAStar>(); }},
+        {"Bidirectional A*", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<BidirectionalAStar>(); }},
+        {"Flow field", []() -> std::unique_ptr<PathingAlgorithm> { return std::make_unique<FlowFieldSearch>(); }},
+    };
+    return algorithms;
+}
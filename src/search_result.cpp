@@ -0,0 +1,85 @@
+#include <cstdlib>
+#include <format>
+#include "search_result.hpp"
+
+using namespace pathfinder2;
+
+SearchResult::SearchResult(const GridShape &shape) :
+    grid_shape{shape},
+    visited_bits{shape.padded_size()},
+    path_bits{shape.padded_size()},
+    g_costs(shape.padded_size(), 0),
+    h_costs(shape.padded_size(), 0)
+{}
+
+void SearchResult::reset(const GridShape &shape) {
+    if (shape != grid_shape) {
+        *this = SearchResult{shape};
+        return;
+    }
+
+    // the costs are only read for marked cells, they can stay
+    for (auto ind : visited_order)
+        visited_bits.reset(ind);
+    for_each_path_point([&](Point p) { path_bits.reset(grid_shape.index(p)); });
+
+    visited_order.clear();
+    segments.clear();
+    path_found = false;
+    search_stats = {};
+}
+
+std::size_t SearchResult::path_length() const {
+    std::size_t len = 0;
+    for (const auto &segment : segments)
+        len += segment.steps;
+    return len;
+}
+
+int SearchResult::path_cost() const {
+    int cost = 0;
+    for (const auto &segment : segments)
+        cost += static_cast<int>(segment.steps) * (segment.dx != 0 && segment.dy != 0 ? 14 : 10);
+    return cost;
+}
+
+std::optional<std::string> SearchResult::describe(Point p) const {
+    if (!visited(p) && !on_path(p))
+        return std::nullopt;
+
+    // the ui has always labelled the cost so far h_cost and the heuristic g_cost
+    int g = g_cost(p), h = h_cost(p);
+    return std::format("h_cost: {:3} g_cost: {:3} f_cost: {:3}", g, h, g + h);
+}
+
+void SearchResult::mark_visited(std::size_t ind, int g_cost, int h_cost) {
+    visited_bits.set(ind);
+    visited_order.push_back(static_cast<std::uint32_t>(ind));
+    set_costs(ind, g_cost, h_cost);
+}
+
+void SearchResult::set_costs(std::size_t ind, int g_cost, int h_cost) {
+    g_costs[ind] = g_cost;
+    h_costs[ind] = h_cost;
+}
+
+void SearchResult::set_path(const std::vector<std::uint32_t> &waypoints) {
+    segments.clear();
+    path_found = !waypoints.empty();
+
+    for (std::size_t i = 0; i + 1 < waypoints.size(); i++) {
+        Point from = grid_shape.point(waypoints[i]);
+        Point to = grid_shape.point(waypoints[i + 1]);
+        auto dx = static_cast<std::int8_t>(sign(to.first - from.first));
+        auto dy = static_cast<std::int8_t>(sign(to.second - from.second));
+        auto steps = static_cast<std::uint32_t>(std::max(std::abs(to.first - from.first), std::abs(to.second - from.second)));
+
+        // consecutive waypoints heading the same way are merged into one segment
+        if (!segments.empty() && segments.back().dx == dx && segments.back().dy == dy)
+            segments.back().steps += steps;
+        else
+            segments.push_back({from, dx, dy, steps});
+    }
+
+    for_each_path_point([&](Point p) { path_bits.set(grid_shape.index(p)); });
+}
@@ -0,0 +1,15 @@
+#include <format>
+#include "search_stats.hpp"
+
+using namespace pathfinder2;
+
+std::string SearchStats::summary() const {
+    return std::format("expanded {} pushed {} heap ops {} reparents {} scratch {:.1f} KiB {:.3f} ms",
+            expanded, pushed, heap_ops, reparents, peak_scratch_bytes / 1024.0, elapsed_ms);
+}
+
+std::string SearchStats::to_json() const {
+    return std::format("{{\"expanded\": {}, \"pushed\": {}, \"heap_ops\": {}, \"reparents\": {}, "
+            "\"peak_scratch_bytes\": {}, \"elapsed_ms\": {:.3f}}}",
+            expanded, pushed, heap_ops, reparents, peak_scratch_bytes, elapsed_ms);
+}
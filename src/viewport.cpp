@@ -0,0 +1,160 @@
+#include <algorithm>
+#include <cmath>
+#include "viewport.hpp"
+
+using namespace pathfinder2;
+using namespace pathfinder2::ui;
+
+Camera::Camera(const GridShape &map, int view_width, int view_height, double native_cell_px) :
+    map{map},
+    view_width{view_width},
+    view_height{view_height}
+{
+    // zooming out stops once the whole map fits, zooming in at twice the textures' size
+    double fit_scale = std::min(static_cast<double>(view_width) / map.width(), static_cast<double>(view_height) / map.height());
+    min_scale = std::min(fit_scale, native_cell_px);
+    max_scale = 2 * native_cell_px;
+    scale = native_cell_px;
+    fit();
+}
+
+Point Camera::cell_at(int view_x, int view_y) const {
+    // nudged by the forward transform so hit testing agrees with drawing at the cell borders
+
+    int x = static_cast<int>(std::floor(left + view_x / scale));
+    if (this->view_x(x + 1) <= view_x)
+        x++;
+    else if (this->view_x(x) > view_x)
+        x--;
+
+    int y = static_cast<int>(std::floor(top + view_y / scale));
+    if (this->view_y(y + 1) <= view_y)
+        y++;
+    else if (this->view_y(y) > view_y)
+        y--;
+
+    return {x, y};
+}
+
+int Camera::view_x(int cell_x) const {
+    return static_cast<int>(std::floor((cell_x - left) * scale));
+}
+
+int Camera::view_y(int cell_y) const {
+    return static_cast<int>(std::floor((cell_y - top) * scale));
+}
+
+CellRect Camera::visible() const {
+    Point top_left = cell_at(0, 0);
+    Point bottom_right = cell_at(view_width - 1, view_height - 1);
+    return {
+        std::max(top_left.first, 0),
+        std::max(top_left.second, 0),
+        std::min(bottom_right.first + 1, map.width()),
+        std::min(bottom_right.second + 1, map.height()),
+    };
+}
+
+void Camera::zoom_at(int view_x, int view_y, double factor) {
+    double new_scale = std::clamp(scale * factor, min_scale, max_scale);
+    if (new_scale == scale)
+        return;
+
+    // the map position under the pixel stays under the pixel
+    double cell_x = left + view_x / scale;
+    double cell_y = top + view_y / scale;
+    scale = new_scale;
+    left = cell_x - view_x / scale;
+    top = cell_y - view_y / scale;
+
+    clamp();
+    camera_version++;
+}
+
+void Camera::pan(double dx_px, double dy_px) {
+    left += dx_px / scale;
+    top += dy_px / scale;
+
+    clamp();
+    camera_version++;
+}
+
+void Camera::fit() {
+    scale = std::clamp(std::min(static_cast<double>(view_width) / map.width(), static_cast<double>(view_height) / map.height()),
+            min_scale, max_scale / 2);
+    left = 0;
+    top = 0;
+
+    clamp();
+    camera_version++;
+}
+
+void Camera::clamp() {
+    // at least half of the view stays on the map
+    double view_cells_x = view_width / scale;
+    double view_cells_y = view_height / scale;
+    left = std::clamp(left, -view_cells_x / 2, std::max(map.width() - view_cells_x / 2, -view_cells_x / 2));
+    top = std::clamp(top, -view_cells_y / 2, std::max(map.height() - view_cells_y / 2, -view_cells_y / 2));
+}
+
+DensityPyramid::DensityPyramid(const Grid &grid) : map{grid.shape()} {
+    // each level halves the one below until a single block covers the map
+
+    for (int level = 1; (1 << (level - 1)) < std::max(map.width(), map.height()); level++) {
+        int block = 1 << level;
+        int width = (map.width() + block - 1) / block;
+        int height = (map.height() + block - 1) / block;
+
+        level_widths.push_back(width);
+        counts.emplace_back(static_cast<std::size_t>(width) * height, 0);
+
+        for (int y = 0; y < height; y++) {
+            for (int x = 0; x < width; x++)
+                counts.back()[static_cast<std::size_t>(y) * width + x] = count(grid, level, x, y);
+        }
+    }
+}
+
+std::uint32_t DensityPyramid::count(const Grid &grid, int level, int block_x, int block_y) const {
+    // sums the four blocks of the level below, level 1 looks at the cells directly
+
+    std::uint32_t total = 0;
+    for (int dy = 0; dy < 2; dy++) {
+        for (int dx = 0; dx < 2; dx++) {
+            int x = 2 * block_x + dx, y = 2 * block_y + dy;
+            if (level == 1) {
+                if (map.in_bounds({x, y}) && !grid.walkable(grid.index({x, y})))
+                    total++;
+                continue;
+            }
+
+            const auto &below = counts[level - 2];
+            int below_width = level_widths[level - 2];
+            int below_height = static_cast<int>(below.size()) / below_width;
+            if (x < below_width && y < below_height)
+                total += below[static_cast<std::size_t>(y) * below_width + x];
+        }
+    }
+    return total;
+}
+
+std::uint8_t DensityPyramid::density(int level, int block_x, int block_y) const {
+    const int block = 1 << level;
+
+    // blocks along the right and bottom edge hang off the map, only the part on it counts
+    int covered_x = std::min(block, map.width() - block_x * block);
+    int covered_y = std::min(block, map.height() - block_y * block);
+    if (covered_x <= 0 || covered_y <= 0)
+        return 0;
+
+    std::uint64_t blocked = counts[level - 1][static_cast<std::size_t>(block_y) * level_widths[level - 1] + block_x];
+    return static_cast<std::uint8_t>(blocked * 255 / (static_cast<std::uint64_t>(covered_x) * covered_y));
+}
+
+void DensityPyramid::update(const Grid &grid, Point p) {
+    for (int level = 1; level <= levels(); level++) {
+        int block_x = p.first >> level, block_y = p.second >> level;
+        counts[level - 1][static_cast<std::size_t>(block_y) * level_widths[level - 1] + block_x] =
+            count(grid, level, block_x, block_y);
+    }
+}
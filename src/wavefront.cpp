@@ -0,0 +1,286 @@
+#include <algorithm>
+#include <stdexcept>
+#include "wavefront.hpp"
+
+#if defined(__x86_64__) || defined(__i386__)
+#define PF2_WAVEFRONT_X86
+#include <immintrin.h>
+#endif
+
+using namespace pathfinder2;
+
+namespace {
+    std::size_t words_for(int width) {
+        return (static_cast<std::size_t>(width) + 63) / 64;
+    }
+
+    // every kernel steps one row of the frontier: the cells next to a frontier cell in the rows
+    // up, row and down that are open and not visited yet become the next frontier and get marked
+    // visited. the pointers are to the first data word of each row, so [-1] and [words] are the
+    // empty words on the ends. returns whether anything got reached.
+    //
+    // with diagonals the three rows get ored first and then spread sideways, which reaches the
+    // diagonal neighbours too. bit x of a word is column x, so << 1 moves a cell right and the
+    // top bit of the word before carries into bit 0.
+
+    template <bool diagonal>
+    bool step_row_scalar(const std::uint64_t *up, const std::uint64_t *row, const std::uint64_t *down,
+            const std::uint64_t *open, std::uint64_t *visited, std::uint64_t *next, std::size_t words) {
+        std::uint64_t any = 0;
+        for (std::size_t i = 0; i < words; i++) {
+            std::uint64_t reach;
+            if constexpr (diagonal) {
+                std::uint64_t left = up[i - 1] | row[i - 1] | down[i - 1];
+                std::uint64_t mid = up[i] | row[i] | down[i];
+                std::uint64_t right = up[i + 1] | row[i + 1] | down[i + 1];
+                reach = mid | mid << 1 | left >> 63 | mid >> 1 | right << 63;
+            }
+            else {
+                reach = up[i] | down[i] | row[i] << 1 | row[i - 1] >> 63 | row[i] >> 1 | row[i + 1] << 63;
+            }
+
+            std::uint64_t fresh = reach & open[i] & ~visited[i];
+            visited[i] |= fresh;
+            next[i] = fresh;
+            any |= fresh;
+        }
+        return any != 0;
+    }
+
+#ifdef PF2_WAVEFRONT_X86
+    // the same with 2 and 4 words at a time. loading one word to either side gives the
+    // neighbouring words lined up with the ones being stepped, so the carries between words are
+    // the same shifts as in the scalar kernel.
+
+    __attribute__((target("sse2")))
+    inline __m128i load128(const std::uint64_t *p) {
+        return _mm_loadu_si128(reinterpret_cast<const __m128i *>(p));
+    }
+
+    __attribute__((target("avx2")))
+    inline __m256i load256(const std::uint64_t *p) {
+        return _mm256_loadu_si256(reinterpret_cast<const __m256i *>(p));
+    }
+
+    template <bool diagonal>
+    __attribute__((target("sse2")))
+    bool step_row_sse2(const std::uint64_t *up, const std::uint64_t *row, const std::uint64_t *down,
+            const std::uint64_t *open, std::uint64_t *visited, std::uint64_t *next, std::size_t words) {
+        __m128i any = _mm_setzero_si128();
+        for (std::size_t i = 0; i < words; i += 2) {
+            __m128i reach;
+            if constexpr (diagonal) {
+                __m128i left = _mm_or_si128(_mm_or_si128(load128(up + i - 1), load128(row + i - 1)), load128(down + i - 1));
+                __m128i mid = _mm_or_si128(_mm_or_si128(load128(up + i), load128(row + i)), load128(down + i));
+                __m128i right = _mm_or_si128(_mm_or_si128(load128(up + i + 1), load128(row + i + 1)), load128(down + i + 1));
+                reach = _mm_or_si128(_mm_or_si128(mid, _mm_slli_epi64(mid, 1)), _mm_srli_epi64(left, 63));
+                reach = _mm_or_si128(reach, _mm_or_si128(_mm_srli_epi64(mid, 1), _mm_slli_epi64(right, 63)));
+            }
+            else {
+                __m128i mid = load128(row + i);
+                reach = _mm_or_si128(load128(up + i), load128(down + i));
+                reach = _mm_or_si128(reach, _mm_or_si128(_mm_slli_epi64(mid, 1), _mm_srli_epi64(load128(row + i - 1), 63)));
+                reach = _mm_or_si128(reach, _mm_or_si128(_mm_srli_epi64(mid, 1), _mm_slli_epi64(load128(row + i + 1), 63)));
+            }
+
+            __m128i seen = load128(visited + i);
+            __m128i fresh = _mm_andnot_si128(seen, _mm_and_si128(reach, load128(open + i)));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(visited + i), _mm_or_si128(seen, fresh));
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(next + i), fresh);
+            any = _mm_or_si128(any, fresh);
+        }
+        return _mm_movemask_epi8(_mm_cmpeq_epi8(any, _mm_setzero_si128())) != 0xffff;
+    }
+
+    template <bool diagonal>
+    __attribute__((target("avx2")))
+    bool step_row_avx2(const std::uint64_t *up, const std::uint64_t *row, const std::uint64_t *down,
+            const std::uint64_t *open, std::uint64_t *visited, std::uint64_t *next, std::size_t words) {
+        __m256i any = _mm256_setzero_si256();
+        for (std::size_t i = 0; i < words; i += 4) {
+            __m256i reach;
+            if constexpr (diagonal) {
+                __m256i left = _mm256_or_si256(_mm256_or_si256(load256(up + i - 1), load256(row + i - 1)), load256(down + i - 1));
+                __m256i mid = _mm256_or_si256(_mm256_or_si256(load256(up + i), load256(row + i)), load256(down + i));
+                __m256i right = _mm256_or_si256(_mm256_or_si256(load256(up + i + 1), load256(row + i + 1)), load256(down + i + 1));
+                reach = _mm256_or_si256(_mm256_or_si256(mid, _mm256_slli_epi64(mid, 1)), _mm256_srli_epi64(left, 63));
+                reach = _mm256_or_si256(reach, _mm256_or_si256(_mm256_srli_epi64(mid, 1), _mm256_slli_epi64(right, 63)));
+            }
+            else {
+                __m256i mid = load256(row + i);
+                reach = _mm256_or_si256(load256(up + i), load256(down + i));
+                reach = _mm256_or_si256(reach, _mm256_or_si256(_mm256_slli_epi64(mid, 1), _mm256_srli_epi64(load256(row + i - 1), 63)));
+                reach = _mm256_or_si256(reach, _mm256_or_si256(_mm256_srli_epi64(mid, 1), _mm256_slli_epi64(load256(row + i + 1), 63)));
+            }
+
+            __m256i seen = load256(visited + i);
+            __m256i fresh = _mm256_andnot_si256(seen, _mm256_and_si256(reach, load256(open + i)));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(visited + i), _mm256_or_si256(seen, fresh));
+            _mm256_storeu_si256(reinterpret_cast<__m256i *>(next + i), fresh);
+            any = _mm256_or_si256(any, fresh);
+        }
+        return !_mm256_testz_si256(any, any);
+    }
+#endif
+}
+
+bool Wavefront::supported(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::Scalar:
+        return true;
+#ifdef PF2_WAVEFRONT_X86
+    case Kernel::SSE2:
+        return __builtin_cpu_supports("sse2");
+    case Kernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+Wavefront::Kernel Wavefront::best_kernel() {
+    static const Kernel best = supported(Kernel::AVX2) ? Kernel::AVX2 : supported(Kernel::SSE2) ? Kernel::SSE2 : Kernel::Scalar;
+    return best;
+}
+
+const char *Wavefront::kernel_name(Kernel kernel) {
+    switch (kernel) {
+    case Kernel::SSE2:
+        return "sse2";
+    case Kernel::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+void Wavefront::allocate(const GridShape &shape, bool diagonal, Kernel kernel) {
+    if (!supported(kernel))
+        throw std::invalid_argument("wavefront kernel not supported on this cpu");
+
+    grid_shape = shape;
+    diagonal_steps = diagonal;
+    row_kernel = kernel;
+
+    switch (kernel) {
+#ifdef PF2_WAVEFRONT_X86
+    case Kernel::SSE2:
+        step_row = diagonal ? step_row_sse2<true> : step_row_sse2<false>;
+        break;
+    case Kernel::AVX2:
+        step_row = diagonal ? step_row_avx2<true> : step_row_avx2<false>;
+        break;
+#endif
+    default:
+        step_row = diagonal ? step_row_scalar<true> : step_row_scalar<false>;
+        break;
+    }
+
+    data_words = (words_for(shape.width()) + 3) / 4 * 4;
+    row_words = data_words + 2;
+    const std::size_t plane_words = (static_cast<std::size_t>(shape.height()) + 2) * row_words;
+    open_cells.assign(plane_words, 0);
+    visited.assign(plane_words, 0);
+    frontier.assign(plane_words, 0);
+    next_frontier.assign(plane_words, 0);
+    dists.assign(shape.padded_size(), unreachable);
+    max_steps = 0;
+}
+
+Wavefront::Wavefront(const Grid &grid, bool diagonal, Kernel kernel) {
+    allocate(grid.shape(), diagonal, kernel);
+    for (int y = 0; y < grid.height(); y++) {
+        std::uint64_t *bits = &open_cells[row_start(y)];
+        for (int x = 0; x < grid.width(); x++) {
+            if (grid.walkable(grid.index({x, y})))
+                bits[x / 64] |= std::uint64_t{1} << (x % 64);
+        }
+    }
+}
+
+Wavefront::Wavefront(const BitPlane &plane, bool diagonal, Kernel kernel) {
+    allocate({plane.width(), plane.height()}, diagonal, kernel);
+
+    // the plane has obsticals set, the bits past the width have to stay closed here
+    const std::size_t words = words_for(plane.width());
+    const std::uint64_t last_mask = plane.width() % 64 == 0 ? UINT64_MAX : (std::uint64_t{1} << (plane.width() % 64)) - 1;
+    for (int y = 0; y < plane.height(); y++) {
+        const std::uint64_t *blocked = plane.row(y);
+        std::uint64_t *bits = &open_cells[row_start(y)];
+        for (std::size_t w = 0; w < words; w++)
+            bits[w] = ~blocked[w];
+        bits[words - 1] &= last_mask;
+    }
+}
+
+std::size_t Wavefront::memory_bytes() const {
+    return (open_cells.capacity() + visited.capacity() + frontier.capacity() + next_frontier.capacity()) * sizeof(std::uint64_t) +
+            dists.capacity() * sizeof(dists[0]) + (frontier_rows.capacity() + next_rows.capacity()) * sizeof(int);
+}
+
+void Wavefront::cell_changed(const Grid &grid, Point p) {
+    std::uint64_t &word = open_cells[row_start(p.second) + static_cast<std::size_t>(p.first) / 64];
+    const std::uint64_t bit = std::uint64_t{1} << (p.first % 64);
+    if (grid.walkable(grid.index(p)))
+        word |= bit;
+    else
+        word &= ~bit;
+}
+
+void Wavefront::run(Point source) {
+    if (!grid_shape.in_bounds(source))
+        throw std::invalid_argument("wavefront source out of bounds");
+
+    source_point = source;
+    max_steps = 0;
+    std::fill(dists.begin(), dists.end(), unreachable);
+    std::fill(visited.begin(), visited.end(), 0);
+
+    const std::size_t source_word = row_start(source.second) + static_cast<std::size_t>(source.first) / 64;
+    const std::uint64_t source_bit = std::uint64_t{1} << (source.first % 64);
+    if ((open_cells[source_word] & source_bit) == 0)
+        return;
+
+    frontier[source_word] = source_bit;
+    visited[source_word] = source_bit;
+    dists[grid_shape.index(source)] = 0;
+
+    // only the rows the frontier is on and the ones next to them can change in a step, on a
+    // maze that's a handful of rows out of the whole map. the frontier rows get cleared once
+    // stepped, so both frontier planes are empty outside of the rows listed for them.
+
+    frontier_rows.assign(1, source.second);
+    for (int steps = 1; !frontier_rows.empty(); steps++) {
+        next_rows.clear();
+
+        // the rows are in order, so the rows around them come out in order too
+        int last_stepped = -2;
+        for (int row : frontier_rows) {
+            for (int y = std::max({row - 1, last_stepped + 1, 0}); y <= std::min(row + 1, grid_shape.height() - 1); y++) {
+                last_stepped = y;
+                std::uint64_t *next = &next_frontier[row_start(y)];
+                if (!step_row(&frontier[row_start(y - 1)], &frontier[row_start(y)], &frontier[row_start(y + 1)],
+                        &open_cells[row_start(y)], &visited[row_start(y)], next, data_words))
+                    continue;
+
+                next_rows.push_back(y);
+
+                // the distances are the one part that goes cell by cell, skipping the empty words
+                for (std::size_t w = 0; w < data_words; w++) {
+                    for (std::uint64_t word = next[w]; word != 0; word &= word - 1) {
+                        int x = static_cast<int>(w * 64) + __builtin_ctzll(word);
+                        dists[grid_shape.index({x, y})] = steps;
+                    }
+                }
+            }
+        }
+
+        for (int row : frontier_rows)
+            std::fill_n(frontier.begin() + row_start(row), data_words, 0);
+        frontier.swap(next_frontier);
+        frontier_rows.swap(next_rows);
+        if (!frontier_rows.empty())
+            max_steps = steps;
+    }
+}